@@ -0,0 +1,102 @@
+#ifndef ZPP_THROWING_BENCHMARK_H
+#define ZPP_THROWING_BENCHMARK_H
+
+#include "zpp_throwing.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+namespace benchmark
+{
+/**
+ * The number of global operator new calls made so far.
+ */
+std::size_t allocations() noexcept;
+
+/**
+ * The number of data TLB misses of the current thread so far, or -1
+ * if the hardware counter is not available.
+ */
+long long dtlb_misses() noexcept;
+
+/**
+ * The number of instruction cache misses of the current thread so far,
+ * or -1 if the hardware counter is not available.
+ */
+long long icache_misses() noexcept;
+
+/**
+ * Registers a benchmark, returns true.
+ */
+bool register_benchmark(std::string_view name,
+                        void (*function)(std::size_t iterations));
+
+/**
+ * Prevents the compiler from optimizing the value away.
+ */
+template <typename Type>
+inline void do_not_optimize(Type && value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Runs the benchmark function and reports the average time, number
+ * of allocations, data TLB misses and instruction cache misses per
+ * iteration.
+ */
+inline void run(std::string_view name,
+                void (*function)(std::size_t iterations),
+                std::size_t iterations)
+{
+    // Warm up.
+    function(iterations / 10 + 1);
+
+    auto allocations_before = allocations();
+    auto dtlb_misses_before = dtlb_misses();
+    auto icache_misses_before = icache_misses();
+    auto start = std::chrono::steady_clock::now();
+    function(iterations);
+    auto end = std::chrono::steady_clock::now();
+    auto icache_misses_after = icache_misses();
+    auto dtlb_misses_after = dtlb_misses();
+    auto allocations_after = allocations();
+
+    std::printf(
+        "%-60.*s %10.2f ns/op %8.2f allocs/op",
+        int(name.size()),
+        name.data(),
+        double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   end - start)
+                   .count()) /
+            double(iterations),
+        double(allocations_after - allocations_before) /
+            double(iterations));
+    if (dtlb_misses_before >= 0) {
+        std::printf(" %8.4f dtlb-misses/op",
+                    double(dtlb_misses_after - dtlb_misses_before) /
+                        double(iterations));
+    }
+    if (icache_misses_before >= 0) {
+        std::printf(" %8.4f icache-misses/op",
+                    double(icache_misses_after - icache_misses_before) /
+                        double(iterations));
+    }
+    std::printf("\n");
+}
+
+} // namespace benchmark
+
+/**
+ * Defines a benchmark, the body receives the number of iterations
+ * to run as `iterations`.
+ */
+#define BENCHMARK(suite, name)                                             \
+    static void suite##_##name##_benchmark(std::size_t iterations);       \
+    [[maybe_unused]] static const bool suite##_##name##_registered =      \
+        ::benchmark::register_benchmark(#suite "." #name,                 \
+                                        &suite##_##name##_benchmark);     \
+    static void suite##_##name##_benchmark(std::size_t iterations)
+
+#endif // ZPP_THROWING_BENCHMARK_H
@@ -0,0 +1,103 @@
+#include "benchmark.h"
+#include <array>
+#include <utility>
+
+namespace
+{
+
+[[gnu::noinline]] zpp::throwing<int> fail(int value)
+{
+    if (value < 0) {
+        co_yield zpp::static_runtime_error("Negative value.");
+    }
+    if (value == 0) {
+        co_yield std::errc::invalid_argument;
+    }
+    co_return value;
+}
+
+// Each site has its own clause types, and as such its own catch code,
+// such that alternating between many sites exercises the instruction
+// cache with the catch code of all of them.
+template <int Site>
+[[gnu::noinline]] int catch_site(int value)
+{
+    return zpp::try_catch(
+        [&]() -> zpp::throwing<int> { co_return co_await fail(value); },
+        [](const zpp::static_logic_error &) { return Site; },
+        [](std::errc) { return -Site; },
+        [](const std::exception &) { return Site + 1; },
+        []() { return -1; });
+}
+
+// A site with a single clause besides the catch all clause, which
+// catches the exact type of the exception.
+template <int Site>
+[[gnu::noinline]] int single_clause_site(int value)
+{
+    return zpp::try_catch(
+        [&]() -> zpp::throwing<int> { co_return co_await fail(value); },
+        [](const zpp::static_runtime_error &) { return Site; },
+        []() { return -1; });
+}
+
+// A site with error clauses only.
+template <int Site>
+[[gnu::noinline]] int error_site(int value)
+{
+    return zpp::try_catch(
+        [&]() -> zpp::throwing<int> { co_return co_await fail(value); },
+        [](std::errc) { return Site; },
+        [](zpp::error) { return -Site; },
+        []() { return -1; });
+}
+
+template <int... Sites>
+constexpr auto make_catch_sites(std::integer_sequence<int, Sites...>)
+{
+    return std::array{std::array{&catch_site<Sites>...},
+                      std::array{&single_clause_site<Sites>...},
+                      std::array{&error_site<Sites>...}};
+}
+
+// The sites of each kind, by the order of the site templates above.
+constexpr auto catch_sites =
+    make_catch_sites(std::make_integer_sequence<int, 64>{});
+
+void run_catch_sites(std::size_t kind,
+                     std::size_t number_of_sites,
+                     int value,
+                     std::size_t iterations)
+{
+    auto & sites = catch_sites[kind];
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(sites[i % number_of_sites](value));
+    }
+}
+
+} // namespace
+
+BENCHMARK(catch_sites, exception_at_1_site)
+{
+    run_catch_sites(0, 1, -1, iterations);
+}
+
+BENCHMARK(catch_sites, exception_at_64_sites)
+{
+    run_catch_sites(0, 64, -1, iterations);
+}
+
+BENCHMARK(catch_sites, error_at_64_sites)
+{
+    run_catch_sites(0, 64, 0, iterations);
+}
+
+BENCHMARK(catch_sites, exception_at_64_single_clause_sites)
+{
+    run_catch_sites(1, 64, -1, iterations);
+}
+
+BENCHMARK(catch_sites, error_at_64_error_sites)
+{
+    run_catch_sites(2, 64, 0, iterations);
+}
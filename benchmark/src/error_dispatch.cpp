@@ -0,0 +1,113 @@
+#include "benchmark.h"
+
+namespace
+{
+
+template <int Domain>
+struct domain
+{
+    enum class code
+    {
+        success = 0,
+        failure = Domain + 1,
+    };
+};
+
+template <int Domain>
+using error_code = typename domain<Domain>::code;
+
+} // namespace
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<0>> = zpp::make_error_domain(
+    "error_code<0>", error_code<0>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<1>> = zpp::make_error_domain(
+    "error_code<1>", error_code<1>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<2>> = zpp::make_error_domain(
+    "error_code<2>", error_code<2>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<3>> = zpp::make_error_domain(
+    "error_code<3>", error_code<3>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<4>> = zpp::make_error_domain(
+    "error_code<4>", error_code<4>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<5>> = zpp::make_error_domain(
+    "error_code<5>", error_code<5>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<6>> = zpp::make_error_domain(
+    "error_code<6>", error_code<6>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<error_code<7>> = zpp::make_error_domain(
+    "error_code<7>", error_code<7>::success, [](auto) constexpr {
+        return std::string_view("Failure.");
+    });
+
+namespace
+{
+
+template <typename ErrorCode>
+[[gnu::noinline]] zpp::throwing<int> fail(int value)
+{
+    if (value < 0) {
+        co_yield ErrorCode::failure;
+    }
+    co_return value;
+}
+
+// Throws an error of the given domain, and catches it at a catch site
+// with a clause for each of eight domains.
+template <typename ErrorCode>
+void run_catch_error(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int> {
+                co_return co_await fail<ErrorCode>(-1);
+            },
+            [](error_code<0> error) { return int(error); },
+            [](error_code<1> error) { return int(error); },
+            [](error_code<2> error) { return int(error); },
+            [](error_code<3> error) { return int(error); },
+            [](error_code<4> error) { return int(error); },
+            [](error_code<5> error) { return int(error); },
+            [](error_code<6> error) { return int(error); },
+            [](error_code<7> error) { return int(error); },
+            []() { return -1; }));
+    }
+}
+
+} // namespace
+
+BENCHMARK(error_dispatch, catch_first_of_8_domains)
+{
+    run_catch_error<error_code<0>>(iterations);
+}
+
+BENCHMARK(error_dispatch, catch_last_of_8_domains)
+{
+    run_catch_error<error_code<7>>(iterations);
+}
@@ -0,0 +1,58 @@
+#include "benchmark.h"
+
+namespace
+{
+
+struct cached_error : std::out_of_range
+{
+    using std::out_of_range::out_of_range;
+};
+
+} // namespace
+
+template <>
+struct zpp::define_exception<cached_error>
+{
+    using type = zpp::define_exception_bases<std::out_of_range>;
+};
+
+template <>
+inline constexpr std::size_t zpp::exception_cache_capacity<cached_error> =
+    4;
+
+namespace
+{
+
+template <typename Exception>
+[[gnu::noinline]] zpp::throwing<int> find(int key)
+{
+    if (key < 0) {
+        co_yield Exception("Key not found.");
+    }
+    co_return key;
+}
+
+template <typename Exception>
+void run_throw(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int> {
+                co_return co_await find<Exception>(-1);
+            },
+            [](const std::out_of_range &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+} // namespace
+
+BENCHMARK(exception_cache, throw_uncached)
+{
+    run_throw<std::out_of_range>(iterations);
+}
+
+BENCHMARK(exception_cache, throw_cached)
+{
+    run_throw<cached_error>(iterations);
+}
@@ -0,0 +1,119 @@
+#include "benchmark.h"
+
+namespace
+{
+
+template <int Level>
+struct level_error : level_error<Level - 1>
+{
+    using level_error<Level - 1>::level_error;
+};
+
+template <>
+struct level_error<0> : zpp::static_runtime_error
+{
+    using zpp::static_runtime_error::static_runtime_error;
+};
+
+template <int Index>
+struct other_error : zpp::static_logic_error
+{
+    using zpp::static_logic_error::static_logic_error;
+};
+
+} // namespace
+
+template <int Level>
+struct zpp::define_exception<level_error<Level>>
+{
+    using type = zpp::define_exception_bases<level_error<Level - 1>>;
+};
+
+template <>
+struct zpp::define_exception<level_error<0>>
+{
+    using type = zpp::define_exception_bases<zpp::static_runtime_error>;
+};
+
+template <int Index>
+struct zpp::define_exception<other_error<Index>>
+{
+    using type = zpp::define_exception_bases<zpp::static_logic_error>;
+};
+
+template <>
+inline constexpr std::size_t
+    zpp::exception_cache_capacity<level_error<5>> = 4;
+
+template <>
+inline constexpr std::size_t
+    zpp::exception_cache_capacity<level_error<10>> = 4;
+
+namespace
+{
+
+template <typename Exception>
+[[gnu::noinline]] zpp::throwing<int> fail(int value)
+{
+    if (value < 0) {
+        co_yield zpp::make_exception<Exception>(
+            zpp::static_message("Deep failure."));
+    }
+    co_return value;
+}
+
+// Throws the given level of the hierarchy and catches it by its root,
+// after trying an unrelated clause that scans the whole table.
+template <typename Exception>
+void run_catch_root(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int> {
+                co_return co_await fail<Exception>(-1);
+            },
+            [](const zpp::static_logic_error &) { return -3; },
+            [](const std::exception &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+// Throws the given level of the hierarchy and catches it by its root,
+// after trying eight unrelated clauses.
+template <typename Exception>
+void run_catch_root_after_8(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int> {
+                co_return co_await fail<Exception>(-1);
+            },
+            [](const other_error<0> &) { return -3; },
+            [](const other_error<1> &) { return -4; },
+            [](const other_error<2> &) { return -5; },
+            [](const other_error<3> &) { return -6; },
+            [](const other_error<4> &) { return -7; },
+            [](const other_error<5> &) { return -8; },
+            [](const other_error<6> &) { return -9; },
+            [](const other_error<7> &) { return -10; },
+            [](const std::exception &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+} // namespace
+
+BENCHMARK(exception_matching, catch_root_of_level_5)
+{
+    run_catch_root<level_error<5>>(iterations);
+}
+
+BENCHMARK(exception_matching, catch_root_of_level_10)
+{
+    run_catch_root<level_error<10>>(iterations);
+}
+
+BENCHMARK(exception_matching, catch_root_of_level_5_after_8)
+{
+    run_catch_root_after_8<level_error<5>>(iterations);
+}
@@ -0,0 +1,68 @@
+#include "benchmark.h"
+
+namespace
+{
+
+template <typename Allocator>
+[[gnu::noinline]] zpp::throwing<int, Allocator> leaf(int value)
+{
+    if (value < 0) {
+        co_yield std::runtime_error("Negative value.");
+    }
+    co_return value + 1;
+}
+
+template <typename Allocator>
+[[gnu::noinline]] zpp::throwing<int, Allocator> chain(int value)
+{
+    auto result = co_await leaf<Allocator>(value);
+    co_return co_await leaf<Allocator>(result);
+}
+
+template <typename Allocator>
+void run_chain(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int, Allocator> {
+                co_return co_await chain<Allocator>(int(i & 0xff));
+            },
+            [](const std::exception &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+template <typename Allocator>
+void run_chain_throw(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int, Allocator> {
+                co_return co_await chain<Allocator>(-1);
+            },
+            [](const std::exception &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+} // namespace
+
+BENCHMARK(frame_recycler, chain_new)
+{
+    run_chain<void>(iterations);
+}
+
+BENCHMARK(frame_recycler, chain_recycled)
+{
+    run_chain<zpp::frame_recycler>(iterations);
+}
+
+BENCHMARK(frame_recycler, chain_throw_new)
+{
+    run_chain_throw<void>(iterations);
+}
+
+BENCHMARK(frame_recycler, chain_throw_recycled)
+{
+    run_chain_throw<zpp::frame_recycler>(iterations);
+}
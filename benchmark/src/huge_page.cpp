@@ -0,0 +1,89 @@
+#include "benchmark.h"
+#include "zpp_throwing_allocators.h"
+
+#if __has_include(<sys/mman.h>)
+
+namespace
+{
+
+constexpr int chain_depth = 64;
+
+template <typename Allocator>
+[[gnu::noinline]] zpp::throwing<int, Allocator> deep(int depth, bool fail)
+{
+    if (!depth) {
+        if (fail) {
+            co_yield std::runtime_error("Bottom reached.");
+        }
+        co_return 0;
+    }
+    co_return 1 + co_await deep<Allocator>(depth - 1, fail);
+}
+
+/**
+ * Keeps unrelated heap objects between the frames allocated from the
+ * heap, as in a long running process where the heap is fragmented.
+ */
+struct scattered_heap
+{
+    scattered_heap()
+    {
+        for (auto & block : blocks) {
+            block = ::operator new(4096);
+        }
+        for (std::size_t i = 0; i < std::size(blocks); i += 2) {
+            ::operator delete(blocks[i]);
+            blocks[i] = nullptr;
+        }
+    }
+
+    ~scattered_heap()
+    {
+        for (auto block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    void * blocks[4096]{};
+};
+
+template <typename Allocator>
+void run_deep_chain(std::size_t iterations, bool fail)
+{
+    scattered_heap heap;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int, Allocator> {
+                co_return co_await deep<Allocator>(chain_depth, fail);
+            },
+            [](const std::exception &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+} // namespace
+
+// Results are per frame of the chain.
+BENCHMARK(huge_page, deep_chain_new)
+{
+    run_deep_chain<void>(iterations / chain_depth, false);
+}
+
+BENCHMARK(huge_page, deep_chain_huge_page)
+{
+    run_deep_chain<zpp::huge_page_allocator>(iterations / chain_depth,
+                                             false);
+}
+
+BENCHMARK(huge_page, deep_chain_throw_new)
+{
+    run_deep_chain<void>(iterations / chain_depth, true);
+}
+
+BENCHMARK(huge_page, deep_chain_throw_huge_page)
+{
+    run_deep_chain<zpp::huge_page_allocator>(iterations / chain_depth,
+                                             true);
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "benchmark.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::atomic<std::size_t> allocation_count;
+
+struct benchmark_entry
+{
+    std::string_view name;
+    void (*function)(std::size_t iterations);
+};
+
+// Registration happens during static initialization of other
+// translation units, hence access the entries through a function.
+auto & entries()
+{
+    static benchmark_entry entries[128];
+    return entries;
+}
+
+std::size_t number_of_entries;
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    std::abort();
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+std::size_t benchmark::allocations() noexcept
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+#if __has_include(<linux/perf_event.h>)
+namespace
+{
+// Opens a counter of read misses of the given hardware cache, which
+// counts the calling thread, or returns -1 if not available.
+int open_cache_miss_counter(unsigned long long cache) noexcept
+{
+    perf_event_attr attributes{};
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HW_CACHE;
+    attributes.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    return int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+long long read_counter(int counter) noexcept
+{
+    long long count{};
+    if (counter < 0 ||
+        read(counter, &count, sizeof(count)) != sizeof(count)) {
+        return -1;
+    }
+    return count;
+}
+} // namespace
+#endif
+
+long long benchmark::dtlb_misses() noexcept
+{
+#if __has_include(<linux/perf_event.h>)
+    // Opened once, counts the calling thread from the first call.
+    static thread_local int counter =
+        open_cache_miss_counter(PERF_COUNT_HW_CACHE_DTLB);
+    return read_counter(counter);
+#else
+    return -1;
+#endif
+}
+
+long long benchmark::icache_misses() noexcept
+{
+#if __has_include(<linux/perf_event.h>)
+    // Opened once, counts the calling thread from the first call.
+    static thread_local int counter =
+        open_cache_miss_counter(PERF_COUNT_HW_CACHE_L1I);
+    return read_counter(counter);
+#else
+    return -1;
+#endif
+}
+
+bool benchmark::register_benchmark(std::string_view name,
+                                   void (*function)(std::size_t iterations))
+{
+    if (number_of_entries == std::size(entries())) {
+        std::abort();
+    }
+    entries()[number_of_entries++] = {name, function};
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    // Optional filter by name prefix, and number of iterations.
+    std::string_view filter = argc > 1 ? argv[1] : "";
+    std::size_t iterations =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+
+    for (std::size_t index = 0; index < number_of_entries; ++index) {
+        auto & entry = entries()[index];
+        if (entry.name.substr(0, filter.size()) == filter) {
+            benchmark::run(entry.name, entry.function, iterations);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+#include "zpp_throwing_allocators.h"
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+
+constexpr std::size_t thread_count = 4;
+
+template <typename Allocator>
+[[gnu::noinline]] zpp::throwing<int, Allocator> leaf(int value)
+{
+    if (value < 0) {
+        co_yield std::runtime_error("Negative value.");
+    }
+    co_return value + 1;
+}
+
+template <typename Allocator>
+[[gnu::noinline]] zpp::throwing<int, Allocator> chain(int value)
+{
+    auto result = co_await leaf<Allocator>(value);
+    co_return co_await leaf<Allocator>(result);
+}
+
+/**
+ * Pins the current thread to a CPU, spreading threads across nodes.
+ * On single node hosts the nodes of the pool are simulated.
+ */
+void pin_thread(std::size_t index)
+{
+#if defined(__linux__)
+    auto cpus = std::thread::hardware_concurrency();
+    if (cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index * (cpus / thread_count + 1) % cpus, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+    auto node = zpp::numa_pool_allocator::current_node();
+    if (index % 2 && node == 0) {
+        zpp::numa_pool_allocator::simulate_node(1);
+    }
+}
+
+template <typename Allocator>
+void run_threads(std::size_t iterations, int value)
+{
+    std::vector<std::thread> threads;
+    for (std::size_t index = 0; index < thread_count; ++index) {
+        threads.emplace_back([=] {
+            pin_thread(index);
+            for (std::size_t i = 0; i < iterations / thread_count; ++i) {
+                benchmark::do_not_optimize(zpp::try_catch(
+                    [&]() -> zpp::throwing<int, Allocator> {
+                        co_return co_await chain<Allocator>(value);
+                    },
+                    [](const std::exception &) { return -1; },
+                    []() { return -2; }));
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+// Results are per iteration over all threads.
+BENCHMARK(numa_pool, threads_new)
+{
+    run_threads<void>(iterations, 1);
+}
+
+BENCHMARK(numa_pool, threads_numa)
+{
+    run_threads<zpp::numa_pool_allocator>(iterations, 1);
+}
+
+BENCHMARK(numa_pool, threads_throw_new)
+{
+    run_threads<void>(iterations, -1);
+}
+
+BENCHMARK(numa_pool, threads_throw_numa)
+{
+    run_threads<zpp::numa_pool_allocator>(iterations, -1);
+}
@@ -0,0 +1,49 @@
+#include "benchmark.h"
+
+namespace
+{
+
+template <typename Exception>
+[[gnu::noinline]] zpp::throwing<int> leaf(int value)
+{
+    if (value < 0) {
+        co_yield Exception("Negative value.");
+    }
+    co_return value + 1;
+}
+
+template <typename Exception, typename Catch>
+void run_throw(std::size_t iterations)
+{
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark::do_not_optimize(zpp::try_catch(
+            [&]() -> zpp::throwing<int> {
+                co_return co_await leaf<Exception>(-1);
+            },
+            [](const Catch &) { return -1; },
+            []() { return -2; }));
+    }
+}
+
+} // namespace
+
+BENCHMARK(static_error, throw_runtime_error)
+{
+    run_throw<std::runtime_error, std::exception>(iterations);
+}
+
+BENCHMARK(static_error, throw_static_runtime_error)
+{
+    run_throw<zpp::static_runtime_error, std::exception>(iterations);
+}
+
+BENCHMARK(static_error, throw_out_of_range)
+{
+    run_throw<std::out_of_range, std::logic_error>(iterations);
+}
+
+BENCHMARK(static_error, throw_static_out_of_range)
+{
+    run_throw<zpp::static_out_of_range, zpp::static_logic_error>(
+        iterations);
+}
@@ -0,0 +1,223 @@
+#include "zpp_throwing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+// Counts the frame and exception allocations of throwing coroutines,
+// built with `ZPP_THROWING_ELIDE_FRAMES` defined. Frame allocation
+// elision is a clang optimization, with other compilers the counts are
+// reported but not checked.
+namespace
+{
+
+struct counting_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t size)
+    {
+        ++allocations;
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        ::operator delete(pointer);
+    }
+
+    friend bool operator==(const counting_allocator &,
+                           const counting_allocator &) = default;
+
+    static inline std::size_t allocations{};
+};
+
+template <typename Type>
+using counted = zpp::throwing<Type, counting_allocator>;
+
+// Too large to be stored inline, such that throwing allocates the
+// exception object.
+struct large_error : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+
+    char padding[64]{};
+};
+
+} // namespace
+
+template <>
+struct zpp::define_exception<large_error>
+{
+    using type = zpp::define_exception_bases<std::runtime_error>;
+};
+
+namespace
+{
+
+counted<int> leaf(bool success)
+{
+    if (!success) {
+        co_yield large_error("My runtime error!");
+    }
+    co_return 1337;
+}
+
+counted<int> middle(bool success)
+{
+    co_return co_await leaf(success) + 1;
+}
+
+// Not inlined, such that only awaiting them may elide their frames.
+[[gnu::noinline]] counted<int> opaque_leaf(bool success)
+{
+    if (!success) {
+        co_yield large_error("My runtime error!");
+    }
+    co_return 1337;
+}
+
+[[gnu::noinline]] counted<int> opaque_middle(bool success)
+{
+    co_return co_await opaque_leaf(success) + 1;
+}
+
+int success()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        co_return co_await middle(true);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+int throw_exception()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        co_return co_await middle(false);
+    }, [](const std::runtime_error &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+int rethrow()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        co_return co_await zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(false);
+        }, [](const std::runtime_error &) -> counted<int> {
+            co_yield zpp::rethrow;
+        });
+    }, [](const std::runtime_error &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+int nested_try_catch()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        auto result = co_await zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(false);
+        }, [](const std::runtime_error &) -> counted<int> {
+            co_return co_await middle(true);
+        });
+        co_return result + co_await middle(true);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+int opaque_success()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        co_return co_await opaque_middle(true);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+int opaque_throw()
+{
+    return zpp::try_catch([]() -> counted<int> {
+        co_return co_await opaque_middle(false);
+    }, [](const std::runtime_error &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+#if defined(__clang__)
+constexpr bool elides_inlined = true;
+#else
+constexpr bool elides_inlined = false;
+#endif
+
+#if defined(__clang__) && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::coro_await_elidable)
+#define ELIDES_AWAITED
+#endif
+#endif
+
+#if defined(ELIDES_AWAITED)
+constexpr bool elides_awaited = true;
+#else
+constexpr bool elides_awaited = false;
+#endif
+
+struct scenario
+{
+    const char * name;
+    int (*function)();
+    int result;
+
+    // The expected allocations, only the exception objects.
+    std::size_t allocations;
+
+    // Whether the compiler is expected to elide the frames.
+    bool checked;
+};
+
+constexpr scenario scenarios[] = {
+    {"success", success, 1338, 0, elides_inlined},
+    {"throw", throw_exception, -1, 1, elides_inlined},
+    {"rethrow", rethrow, -1, 1, elides_inlined},
+    {"nested_try_catch", nested_try_catch, 2676, 1, elides_inlined},
+    {"opaque_success", opaque_success, 1338, 0, elides_awaited},
+    {"opaque_throw", opaque_throw, -1, 1, elides_awaited},
+};
+
+} // namespace
+
+int main()
+{
+    int failures = 0;
+    for (auto & scenario : scenarios) {
+        auto before = counting_allocator::allocations;
+        auto result = scenario.function();
+        auto allocations = counting_allocator::allocations - before;
+
+        bool failed = result != scenario.result ||
+                      (scenario.checked &&
+                       allocations != scenario.allocations);
+        auto status = failed             ? ", FAILED"
+                      : scenario.checked ? ""
+                                         : ", not checked";
+        std::printf("%-24s %zu allocations, expected %zu%s\n",
+                    scenario.name,
+                    allocations,
+                    scenario.allocations,
+                    status);
+        failures += failed;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -25,3 +25,19 @@ struct fail_unless_triggered
 
     int count{};
 };
+
+// An exception that is too large to be stored inline, such that it is
+// allocated with the allocator of the throwing coroutine.
+template <typename Exception>
+struct allocated : Exception
+{
+    using Exception::Exception;
+
+    char padding[64]{};
+};
+
+template <typename Exception>
+struct zpp::define_exception<allocated<Exception>>
+{
+    using type = zpp::define_exception_bases<Exception>;
+};
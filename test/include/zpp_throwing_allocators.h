@@ -0,0 +1,4 @@
+// Include the header with the hack above first, the allocators header
+// then finds it already included.
+#include "zpp_throwing.h"
+#include "../../zpp_throwing_allocators.h"
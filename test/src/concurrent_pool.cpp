@@ -0,0 +1,114 @@
+#include "test.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+using pool = zpp::concurrent_pool_allocator;
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, pool> pooled_divide(int x, int y)
+{
+    if (y == 0) {
+        co_yield allocated<std::overflow_error>("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+struct result_holder
+{
+    zpp::throwing<int, pool> result;
+};
+
+void wait_for(const std::atomic<int> & phase, int value)
+{
+    while (phase.load() != value) {
+        std::this_thread::yield();
+    }
+}
+
+}
+
+TEST(concurrent_pool, same_thread)
+{
+    auto before = pool::statistics();
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(zpp::try_catch([&] {
+            return pooled_divide(8, i ? 0 : 2);
+        }, [](const std::overflow_error &) {
+            return -1;
+        }, []() {
+            return -2;
+        }), i ? -1 : 4);
+    }
+    auto after = pool::statistics();
+
+    // Three frames and two exceptions.
+    EXPECT_EQ(after.allocations - before.allocations, 5u);
+    EXPECT_EQ(after.remote_frees, before.remote_frees);
+}
+
+TEST(concurrent_pool, exception_caught_on_other_thread)
+{
+    std::unique_ptr<result_holder> holder;
+    std::thread([&] {
+        holder.reset(new result_holder{pooled_divide(8, 0)});
+    }).join();
+
+    // The allocating thread exited, its page is freed with the last block.
+    auto before = pool::statistics();
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int, pool> {
+        auto & result = holder->result;
+        co_return co_await result;
+    }, [](const std::overflow_error & error) {
+        EXPECT_STREQ(error.what(), "Divide by zero!");
+        return -1;
+    }, []() {
+        return -2;
+    }), -1);
+    EXPECT_EQ(pool::statistics().remote_frees - before.remote_frees, 1u);
+}
+
+TEST(concurrent_pool, reclaim_remote_frees)
+{
+    constexpr std::size_t block_size = pool::max_block_size;
+    constexpr std::size_t count = 8;
+    std::atomic<int> phase{};
+    std::byte * blocks[count]{};
+    std::byte * reallocated{};
+    struct pool::statistics owner_statistics{};
+
+    std::thread owner([&] {
+        pool allocator;
+        for (auto & block : blocks) {
+            block = allocator.allocate(block_size);
+        }
+        phase = 1;
+        wait_for(phase, 2);
+
+        // Remote frees are reclaimed in one batch.
+        auto before = pool::statistics();
+        reallocated = allocator.allocate(block_size);
+        owner_statistics = pool::statistics();
+        owner_statistics.reclaims -= before.reclaims;
+        allocator.deallocate(reallocated, block_size);
+    });
+
+    wait_for(phase, 1);
+    pool allocator;
+    auto before = pool::statistics();
+    for (auto block : blocks) {
+        allocator.deallocate(block, block_size);
+    }
+    EXPECT_EQ(pool::statistics().remote_frees - before.remote_frees, count);
+
+    phase = 2;
+    owner.join();
+    EXPECT_EQ(owner_statistics.remote_frees, 0u);
+    EXPECT_EQ(owner_statistics.reclaims, 1u);
+    EXPECT_NE(std::find(blocks, blocks + count, reallocated),
+              blocks + count);
+}
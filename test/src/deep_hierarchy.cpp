@@ -0,0 +1,117 @@
+#include "test.h"
+
+namespace
+{
+
+template <int Level>
+struct level : level<Level - 1>
+{
+    explicit level(int value) : level<Level - 1>(value)
+    {
+    }
+};
+
+template <>
+struct level<0>
+{
+    explicit level(int value) : value(value)
+    {
+    }
+
+    int value;
+};
+
+struct tag
+{
+    int tag_value = 7;
+};
+
+struct tagged_base
+{
+    long padding = 0;
+};
+
+// The second base is at a non zero offset, and reaches the root of the
+// hierarchy through a path of several levels.
+struct tagged : tagged_base, tag, level<8>
+{
+    explicit tagged(int value) : level<8>(value)
+    {
+    }
+};
+
+}
+
+template <int Level>
+struct zpp::define_exception<level<Level>>
+{
+    using type = zpp::define_exception_bases<level<Level - 1>>;
+};
+
+template <>
+struct zpp::define_exception<level<0>>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<tag>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<tagged_base>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<tagged>
+{
+    using type = zpp::define_exception_bases<tagged_base, tag, level<8>>;
+};
+
+namespace
+{
+
+template <typename Exception, typename Catch>
+int catch_value()
+{
+    return zpp::try_catch([]() -> zpp::throwing<int> {
+        co_yield Exception(1337);
+    }, [](const Catch & exception) {
+        return exception.value;
+    }, []() {
+        return -1;
+    });
+}
+
+}
+
+TEST(deep_hierarchy, catch_every_level)
+{
+    EXPECT_EQ((catch_value<level<9>, level<9>>()), 1337);
+    EXPECT_EQ((catch_value<level<9>, level<8>>()), 1337);
+    EXPECT_EQ((catch_value<level<9>, level<5>>()), 1337);
+    EXPECT_EQ((catch_value<level<9>, level<1>>()), 1337);
+    EXPECT_EQ((catch_value<level<9>, level<0>>()), 1337);
+}
+
+TEST(deep_hierarchy, derived_not_caught_by_base)
+{
+    EXPECT_EQ((catch_value<level<4>, level<5>>()), -1);
+}
+
+TEST(deep_hierarchy, multiple_bases)
+{
+    EXPECT_EQ((catch_value<tagged, level<0>>()), 1337);
+    EXPECT_EQ((catch_value<tagged, level<8>>()), 1337);
+    EXPECT_EQ(zpp::try_catch([]() -> zpp::throwing<int> {
+        co_yield tagged(1337);
+    }, [](const tag & exception) {
+        return exception.tag_value;
+    }, []() {
+        return -1;
+    }), 7);
+}
@@ -0,0 +1,118 @@
+#include "test.h"
+#include <optional>
+#include <thread>
+
+namespace
+{
+
+using buffer = zpp::emergency_exception_buffer;
+
+// An allocator that always fails to allocate.
+struct failing_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t) noexcept
+    {
+        return nullptr;
+    }
+
+    void deallocate(std::byte *, std::size_t) noexcept
+    {
+    }
+
+    friend bool operator==(const failing_allocator &,
+                           const failing_allocator &) = default;
+};
+
+struct large_exception
+{
+    char data[buffer::slot_size];
+};
+
+// The frame is elided or allocated from the heap, only the exception
+// uses the failing allocator.
+zpp::throwing<int, zpp::inline_frame_allocator<failing_allocator>>
+throw_exception(std::allocator_arg_t,
+                zpp::inline_frame_allocator<failing_allocator>,
+                auto exception)
+{
+    co_yield std::move(exception);
+}
+
+int catch_exception(auto exception)
+{
+    zpp::inline_frame<1024> frame;
+    return zpp::try_catch([&] {
+        return throw_exception(std::allocator_arg, frame, exception);
+    }, [](const std::out_of_range & error) {
+        EXPECT_STREQ(error.what(), "Out of range!");
+        EXPECT_EQ(buffer::in_use(), 1u);
+        return 1;
+    }, [](std::errc error) {
+        EXPECT_EQ(error, std::errc::not_enough_memory);
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+}
+
+template <>
+struct zpp::define_exception<large_exception>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+TEST(emergency_buffer, keeps_exception_type)
+{
+    auto before = buffer::statistics();
+    EXPECT_EQ(catch_exception(allocated<std::out_of_range>("Out of range!")),
+              1);
+    EXPECT_EQ(catch_exception(allocated<std::out_of_range>("Out of range!")),
+              1);
+    EXPECT_EQ(buffer::statistics().uses - before.uses, 2u);
+    EXPECT_EQ(buffer::in_use(), 0u);
+}
+
+TEST(emergency_buffer, too_large)
+{
+    auto before = buffer::statistics();
+    EXPECT_EQ(catch_exception(large_exception{}), -1);
+    EXPECT_EQ(buffer::statistics().uses, before.uses);
+    EXPECT_EQ(buffer::statistics().exhausted - before.exhausted, 1u);
+}
+
+TEST(emergency_buffer, freed_on_another_thread)
+{
+    using result_type = decltype(throw_exception(
+        std::allocator_arg,
+        std::declval<zpp::inline_frame<1024> &>(),
+        allocated<std::out_of_range>("Out of range!")));
+
+    auto before = buffer::statistics();
+    zpp::inline_frame<1024> frame;
+    std::optional<result_type> result;
+
+    // The thread exits while its exception is held in the buffer.
+    std::thread([&] {
+        result.emplace(throw_exception(
+            std::allocator_arg,
+            frame,
+            allocated<std::out_of_range>("Out of range!")));
+    }).join();
+    EXPECT_EQ(buffer::in_use(), 1u);
+    EXPECT_EQ(buffer::statistics().uses, before.uses);
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return std::move(*result);
+    }, [](const std::out_of_range & error) {
+        EXPECT_STREQ(error.what(), "Out of range!");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+    result.reset();
+    EXPECT_EQ(buffer::in_use(), 0u);
+}
@@ -0,0 +1,177 @@
+#include "test.h"
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+
+struct small_error
+{
+    int code;
+};
+
+}
+
+template <>
+struct zpp::define_exception<small_error>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+namespace
+{
+
+[[gnu::noinline]] zpp::throwing<int> read_block(int index)
+{
+    if (index < 0) {
+        co_yield std::out_of_range("Invalid block.");
+    }
+    if (index == 0) {
+        co_yield small_error{1337};
+    }
+    if (index == 1) {
+        co_yield std::errc::io_error;
+    }
+    co_return index;
+}
+
+[[gnu::noinline]] zpp::throwing<int> load_shard(int index)
+{
+    co_return co_await read_block(index).context("while reading block");
+}
+
+[[gnu::noinline]] zpp::throwing<int> load_table(int index)
+{
+    co_return co_await load_shard(index).context("while loading shard");
+}
+
+[[gnu::noinline]] zpp::throwing<int> fail_deep(int depth)
+{
+    if (!depth) {
+        co_yield std::runtime_error("Deep failure.");
+    }
+    co_return co_await fail_deep(depth - 1).context("while recursing");
+}
+
+}
+
+TEST(error_context, chain)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return load_table(-1);
+    }, [](const std::exception &) {
+        auto context = zpp::current_error_context();
+        EXPECT_EQ(context.size(), 2u);
+        EXPECT_EQ(context[0], "while reading block");
+        EXPECT_EQ(context[1], "while loading shard");
+        return 1;
+    }, []() {
+        return -1;
+    }), 1);
+}
+
+TEST(error_context, inline_exception)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return load_table(0);
+    }, [](const small_error & error) {
+        EXPECT_EQ(zpp::current_error_context().size(), 2u);
+        return error.code;
+    }, []() {
+        return -1;
+    }), 1337);
+}
+
+TEST(error_context, catch_all)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return load_table(-1);
+    }, []() {
+        return int(zpp::current_error_context().size());
+    }), 2);
+}
+
+TEST(error_context, deep)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return fail_deep(100);
+    }, [](const std::runtime_error &) {
+        auto context = zpp::current_error_context();
+        for (auto message : context) {
+            EXPECT_EQ(message, "while recursing");
+        }
+        return int(context.size());
+    }, []() {
+        return -1;
+    }), 100);
+}
+
+TEST(error_context, deep_index)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return fail_deep(100);
+    }, [](const std::runtime_error &) {
+        auto context = zpp::current_error_context();
+        EXPECT_EQ(context[0], "while recursing");
+        EXPECT_EQ(context[99], "while recursing");
+        return int(std::distance(context.begin(), context.end()));
+    }, []() {
+        return -1;
+    }), 100);
+}
+
+TEST(error_context, none)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return read_block(-1);
+    }, [](const std::exception &) {
+        return int(zpp::current_error_context().size());
+    }, []() {
+        return -1;
+    }), 0);
+
+    EXPECT_TRUE(zpp::current_error_context().empty());
+}
+
+TEST(error_context, error_value)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return load_table(1);
+    }, [](std::errc error) {
+        return int(error);
+    }, []() {
+        return -1;
+    }), int(std::errc::io_error));
+}
+
+TEST(error_context, value)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return load_table(2);
+    }, []() {
+        return -1;
+    }), 2);
+}
+
+TEST(error_context, shared)
+{
+    zpp::throwing<int> result = load_shard(-1);
+    zpp::throwing<int> copy = result.share();
+    zpp::throwing<int> first = std::move(result).context("first");
+    zpp::throwing<int> second = std::move(copy).context("second");
+
+    // Only the context attached before sharing is common to both.
+    auto catch_context = [](zpp::throwing<int> & result) {
+        return std::move(result).catches([](const std::exception &) {
+            auto context = zpp::current_error_context();
+            EXPECT_EQ(context.size(), 1u);
+            EXPECT_EQ(context[0], "while reading block");
+            return int(context.size());
+        }, []() {
+            return -1;
+        });
+    };
+
+    EXPECT_EQ(catch_context(first), 1);
+    EXPECT_EQ(catch_context(second), 1);
+}
@@ -0,0 +1,135 @@
+#include "test.h"
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+enum class first_error
+{
+    success = 0,
+    failure = 1,
+};
+
+enum class second_error
+{
+    success = 0,
+    failure = 2,
+};
+
+enum class third_error
+{
+    success = 0,
+    failure = 3,
+};
+
+enum class unlisted_error
+{
+    success = 0,
+    failure = 4,
+};
+
+constexpr std::string_view error_message(auto code)
+{
+    return code == decltype(code){} ? "Success." : "Failure.";
+}
+
+}
+
+template <>
+inline constexpr auto zpp::err_domain<first_error> = zpp::make_error_domain(
+    "first_error", first_error::success, [](auto code) constexpr {
+        return error_message(code);
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<second_error> = zpp::make_error_domain(
+    "second_error", second_error::success, [](auto code) constexpr {
+        return error_message(code);
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<third_error> = zpp::make_error_domain(
+    "third_error", third_error::success, [](auto code) constexpr {
+        return error_message(code);
+    });
+
+template <>
+inline constexpr auto zpp::err_domain<unlisted_error> =
+    zpp::make_error_domain(
+        "unlisted_error", unlisted_error::success, [](auto code) constexpr {
+            return error_message(code);
+        });
+
+namespace
+{
+
+template <typename Error>
+zpp::throwing<int> fail(Error error)
+{
+    co_yield error;
+}
+
+template <typename Error>
+int catch_error(Error error)
+{
+    return zpp::try_catch([&] { return fail(error); },
+                          [](std::errc) { return 10; },
+                          [](first_error error) { return 10 + int(error); },
+                          [](second_error error) { return 20 + int(error); },
+                          [](const std::exception &) { return -2; },
+                          [](third_error error) { return 30 + int(error); },
+                          [](zpp::error error) { return 40 + error.code(); },
+                          []() { return -1; });
+}
+
+}
+
+TEST(error_dispatch, each_domain_repeatedly)
+{
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(catch_error(std::errc::invalid_argument), 10);
+        EXPECT_EQ(catch_error(first_error::failure), 11);
+        EXPECT_EQ(catch_error(second_error::failure), 22);
+        EXPECT_EQ(catch_error(third_error::failure), 33);
+        EXPECT_EQ(catch_error(unlisted_error::failure), 44);
+    }
+}
+
+TEST(error_dispatch, earlier_generic_clause)
+{
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(zpp::try_catch([] { return fail(second_error::failure); },
+                                 [](first_error) { return 1; },
+                                 [](zpp::error) { return 2; },
+                                 [](second_error) { return 3; },
+                                 []() { return -1; }),
+                  2);
+        EXPECT_EQ(zpp::try_catch([] { return fail(first_error::failure); },
+                                 [](first_error) { return 1; },
+                                 [](zpp::error) { return 2; },
+                                 [](second_error) { return 3; },
+                                 []() { return -1; }),
+                  1);
+    }
+}
+
+TEST(error_dispatch, threads)
+{
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{};
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                mismatches += catch_error(first_error::failure) != 11;
+                mismatches += catch_error(second_error::failure) != 22;
+                mismatches += catch_error(third_error::failure) != 33;
+                mismatches += catch_error(unlisted_error::failure) != 44;
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+}
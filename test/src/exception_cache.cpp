@@ -0,0 +1,93 @@
+#include "test.h"
+
+namespace
+{
+
+// Too large to be stored inline, such that it is cached.
+struct lookup_error : std::out_of_range
+{
+    using std::out_of_range::out_of_range;
+
+    char padding[64]{};
+};
+
+}
+
+template <>
+struct zpp::define_exception<lookup_error>
+{
+    using type = zpp::define_exception_bases<std::out_of_range>;
+};
+
+template <>
+inline constexpr std::size_t zpp::exception_cache_capacity<lookup_error> =
+    1;
+
+namespace
+{
+
+using cache = zpp::exception_cache<lookup_error>;
+
+zpp::throwing<int> lookup(int key)
+{
+    if (key < 0) {
+        co_yield lookup_error("Key not found!");
+    }
+    co_return key;
+}
+
+const void * catch_lookup_error()
+{
+    const void * address{};
+    zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await lookup(-1);
+    }, [&](const std::out_of_range & error) {
+        EXPECT_STREQ(error.what(), "Key not found!");
+        address = &error;
+        return 1;
+    }, []() {
+        return -1;
+    });
+    return address;
+}
+
+}
+
+TEST(exception_cache, reuses_freed_exception)
+{
+    auto before = cache::statistics();
+    auto first = catch_lookup_error();
+    auto second = catch_lookup_error();
+    auto after = cache::statistics();
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(after.reused - before.reused + after.allocated -
+                  before.allocated,
+              2u);
+    EXPECT_GE(after.reused - before.reused, 1u);
+}
+
+TEST(exception_cache, bounded)
+{
+    // Fill the cache.
+    catch_lookup_error();
+    auto before = cache::statistics();
+
+    // Two exceptions alive at once, only one is cached once freed.
+    zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await lookup(-1);
+    }, [&](const std::out_of_range &) {
+        catch_lookup_error();
+        catch_lookup_error();
+        return 1;
+    }, []() {
+        return -1;
+    });
+    catch_lookup_error();
+
+    auto after = cache::statistics();
+    EXPECT_EQ(after.reused - before.reused + after.allocated -
+                  before.allocated,
+              4u);
+    EXPECT_EQ(after.allocated - before.allocated, 1u);
+}
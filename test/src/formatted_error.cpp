@@ -0,0 +1,114 @@
+#include "test.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+zpp::throwing<int> find(int key, const char * table)
+{
+    if (key < 0) {
+        co_yield zpp::lazy_formatted_error(
+            "Key {} not found in {} ({}, {}, {{}}).", key, table, 'x', true);
+    }
+    co_return key;
+}
+
+}
+
+TEST(formatted_error, formats_on_first_access)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await find(-1, "users");
+    }, [](const zpp::formatted_error & error) {
+        EXPECT_FALSE(error.is_formatted());
+        EXPECT_STREQ(error.what(),
+                     "Key -1 not found in users (x, true, {}).");
+        EXPECT_TRUE(error.is_formatted());
+
+        // The message is cached.
+        EXPECT_EQ(error.what(), error.what());
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+
+TEST(formatted_error, swallowed_without_formatting)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await find(-1, "users");
+    }, [](const std::exception & error) {
+        EXPECT_FALSE(
+            static_cast<const zpp::formatted_error &>(error).is_formatted());
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+
+TEST(formatted_error, owned_argument)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        std::string name = "orders";
+        co_yield zpp::lazy_formatted_error("Table {} {}", std::move(name));
+    }, [](const zpp::formatted_error & error) {
+        // Placeholders without arguments are kept as is.
+        EXPECT_STREQ(error.what(), "Table orders {}");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+
+#ifdef __cpp_lib_to_chars
+TEST(formatted_error, floating_point_argument)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_yield zpp::lazy_formatted_error("Ratio {}", 0.5);
+    }, [](const zpp::formatted_error & error) {
+        EXPECT_STREQ(error.what(), "Ratio 0.5");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+#endif
+
+TEST(formatted_error, shared_between_threads)
+{
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        auto result = find(-1, "users");
+        std::vector<zpp::throwing<int>> copies;
+        for (int i = 0; i < 4; ++i) {
+            copies.push_back(result.share());
+        }
+
+        std::atomic<int> mismatches{};
+        std::vector<std::thread> threads;
+        for (auto & copy : copies) {
+            threads.emplace_back([&] {
+                std::move(copy).catches(
+                    [&](const zpp::formatted_error & error) {
+                        mismatches +=
+                            std::string_view(error.what()) !=
+                            "Key -1 not found in users (x, true, {}).";
+                        return 0;
+                    },
+                    []() { return -1; });
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(mismatches, 0);
+
+        std::move(result).catches([](const zpp::formatted_error & error) {
+            EXPECT_TRUE(error.is_formatted());
+            return 0;
+        }, []() {
+            return -1;
+        });
+    }
+}
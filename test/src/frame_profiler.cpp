@@ -0,0 +1,139 @@
+// Profiling changes the promise types of this translation unit, hence
+// only coroutines with allocators local to it are used here.
+#define ZPP_THROWING_PROFILE_FRAMES
+#include "test.h"
+#include <thread>
+
+namespace
+{
+
+struct profiled_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t size)
+    {
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        ::operator delete(pointer);
+    }
+
+    friend bool operator==(const profiled_allocator &,
+                           const profiled_allocator &) = default;
+};
+
+template <typename Type>
+using profiled = zpp::throwing<Type, profiled_allocator>;
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] profiled<int> leaf(int value)
+{
+    if (value < 0) {
+        co_yield std::runtime_error("Negative value.");
+    }
+    co_return value + 1;
+}
+
+[[gnu::noinline]] profiled<int> chain(int value)
+{
+    auto result = co_await leaf(value);
+    co_return co_await leaf(result);
+}
+
+int run_chain(int value)
+{
+    return zpp::try_catch([&]() -> profiled<int> {
+        co_return co_await chain(value);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+zpp::frame_profiler::call_site total()
+{
+    zpp::frame_profiler::call_site total{};
+    zpp::frame_profiler::dump([&](const auto & site) {
+        // The overflow site has no address, and holds any frame size.
+        if (site.address) {
+            EXPECT_EQ(site.bytes, site.allocations * site.frame_size);
+        }
+        total.allocations += site.allocations;
+        total.bytes += site.bytes;
+        total.live += site.live;
+    });
+    return total;
+}
+
+}
+
+TEST(frame_profiler, records_sites)
+{
+    auto before = total();
+    EXPECT_EQ(run_chain(1), 3);
+    EXPECT_EQ(run_chain(-1), -1);
+    auto after = total();
+
+    // Each chain allocates the try frame, the chain frame and two
+    // leaf frames, or one leaf frame when throwing.
+    EXPECT_EQ(after.allocations - before.allocations, 7u);
+    EXPECT_GT(after.bytes, before.bytes);
+    EXPECT_EQ(after.live, before.live);
+}
+
+TEST(frame_profiler, live_frames)
+{
+    auto before = total();
+    EXPECT_EQ(zpp::try_catch([&]() -> profiled<int> {
+        auto result = co_await chain(1);
+
+        // The try frame is alive while chain and leaf frames are freed.
+        auto during = total();
+        EXPECT_EQ(during.allocations - before.allocations, 4u);
+        EXPECT_EQ(during.live - before.live, 1u);
+        co_return result;
+    }, []() {
+        return -1;
+    }), 3);
+    EXPECT_EQ(total().live, before.live);
+}
+
+TEST(frame_profiler, other_threads)
+{
+    auto before = total();
+    std::thread([] { EXPECT_EQ(run_chain(1), 3); }).join();
+    auto after = total();
+    EXPECT_EQ(after.allocations - before.allocations, 4u);
+    EXPECT_EQ(after.live, before.live);
+}
+
+TEST(frame_profiler, overflow_bytes)
+{
+    // Fill the table of a new thread with made up sites, such that the
+    // last two sites overflow.
+    std::thread([] {
+        alignas(std::max_align_t)
+            std::byte frame[zpp::frame_profiler::header_size + 64];
+        for (std::size_t i = 0; i < zpp::frame_profiler::table_size + 2;
+             ++i) {
+            auto address =
+                reinterpret_cast<const void *>(std::uintptr_t(0x1000 + i));
+            zpp::frame_profiler::deallocated(zpp::frame_profiler::allocated(
+                frame, i % 2 ? 64 : 32, address));
+        }
+    }).join();
+
+    zpp::frame_profiler::call_site overflow{};
+    zpp::frame_profiler::dump([&](const auto & site) {
+        if (!site.address) {
+            overflow = site;
+        }
+    });
+    EXPECT_EQ(overflow.allocations, 2u);
+    EXPECT_EQ(overflow.bytes, 96u);
+    EXPECT_EQ(overflow.live, 0u);
+}
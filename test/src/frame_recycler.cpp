@@ -0,0 +1,64 @@
+#include "test.h"
+
+namespace
+{
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, zpp::frame_recycler>
+recycled_divide(int x, int y)
+{
+    if (y == 0) {
+        co_yield std::overflow_error("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+}
+
+TEST(frame_recycler, reuse_frames)
+{
+    auto before = zpp::frame_recycler::statistics();
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(recycled_divide(4, 2).value(), 2);
+    }
+
+    auto after = zpp::frame_recycler::statistics();
+    EXPECT_EQ(after.allocations - before.allocations, 3u);
+    EXPECT_EQ(after.deallocations - before.deallocations, 3u);
+    EXPECT_GE(after.recycled - before.recycled, 2u);
+}
+
+TEST(frame_recycler, reuse_frames_on_exception)
+{
+    auto before = zpp::frame_recycler::statistics();
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(zpp::try_catch([]() -> zpp::throwing<int, zpp::frame_recycler> {
+            co_return co_await recycled_divide(4, 0);
+        }, [](const std::overflow_error & error) {
+            EXPECT_STREQ(error.what(), "Divide by zero!");
+            return 1;
+        }, []() {
+            return 2;
+        }), 1);
+    }
+
+    auto after = zpp::frame_recycler::statistics();
+    EXPECT_EQ(after.allocations - before.allocations,
+              after.deallocations - before.deallocations);
+    EXPECT_GE(after.recycled - before.recycled, 2u);
+}
+
+TEST(frame_recycler, release)
+{
+    EXPECT_EQ(recycled_divide(4, 2).value(), 2);
+    zpp::frame_recycler::release();
+
+    auto before = zpp::frame_recycler::statistics();
+    EXPECT_EQ(recycled_divide(4, 2).value(), 2);
+    auto after = zpp::frame_recycler::statistics();
+
+    EXPECT_EQ(after.allocations - before.allocations, 1u);
+    EXPECT_EQ(after.recycled - before.recycled, 0u);
+}
@@ -0,0 +1,75 @@
+#include "test.h"
+#include "zpp_throwing_allocators.h"
+
+#if __has_include(<sys/mman.h>)
+
+namespace
+{
+
+using huge = zpp::huge_page_allocator;
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<std::size_t, huge> deep(int depth)
+{
+    if (!depth) {
+        co_return huge::arena().used();
+    }
+    if (depth < 0) {
+        co_yield allocated<std::runtime_error>("Negative depth.");
+    }
+    co_return co_await deep(depth - 1);
+}
+
+}
+
+TEST(huge_page, frames_are_contiguous)
+{
+    auto used = zpp::try_catch([]() -> zpp::throwing<std::size_t, huge> {
+        auto shallow = co_await deep(1);
+        auto deeper = co_await deep(11);
+
+        // Ten more frames, carved from where the shallow chain was.
+        EXPECT_GT(deeper, shallow);
+        EXPECT_EQ((deeper - shallow) % 10, 0u);
+        co_return deeper;
+    }, [](const std::exception &) {
+        return std::size_t{};
+    }, []() {
+        return std::size_t{};
+    });
+
+    EXPECT_GT(used, 0u);
+    EXPECT_EQ(huge::arena().used(), 0u);
+}
+
+TEST(huge_page, exception_from_arena)
+{
+    EXPECT_EQ(zpp::try_catch([]() -> zpp::throwing<std::size_t, huge> {
+        co_return co_await deep(-1);
+    }, [](const std::runtime_error & error) {
+        EXPECT_STREQ(error.what(), "Negative depth.");
+
+        // The exception is alive in the arena.
+        EXPECT_GT(huge::arena().used(), 0u);
+        return std::size_t{1};
+    }, []() {
+        return std::size_t{};
+    }), 1u);
+
+    EXPECT_EQ(huge::arena().used(), 0u);
+}
+
+TEST(huge_page, exhausted)
+{
+    zpp::huge_page_arena arena(1);
+    auto first = arena.allocate(zpp::huge_page_arena::huge_page_size);
+    ASSERT_NE(first, nullptr);
+    EXPECT_TRUE(arena.contains(first));
+    EXPECT_EQ(arena.allocate(1), nullptr);
+
+    arena.deallocate(first, zpp::huge_page_arena::huge_page_size);
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_NE(arena.allocate(1), nullptr);
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include "test.h"
+
+namespace
+{
+
+struct counting_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t size)
+    {
+        ++allocations;
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        ::operator delete(pointer);
+    }
+
+    friend bool operator==(const counting_allocator &,
+                           const counting_allocator &) = default;
+
+    static inline std::size_t allocations{};
+};
+
+struct empty_tag
+{
+};
+
+struct two_ints
+{
+    int first;
+    int second;
+};
+
+struct tracked
+{
+    explicit tracked(int & alive) : alive(&alive)
+    {
+        ++alive;
+    }
+
+    tracked(tracked && other) noexcept : alive(other.alive)
+    {
+        ++*alive;
+    }
+
+    ~tracked()
+    {
+        --*alive;
+    }
+
+    int * alive;
+};
+
+template <typename Type>
+using counted = zpp::throwing<Type, counting_allocator>;
+
+// Not inlined so that frames are allocated, and the exception is
+// relocated between them.
+template <typename Exception>
+[[gnu::noinline]] counted<int> leaf(Exception exception)
+{
+    co_yield std::move(exception);
+}
+
+template <typename Exception>
+[[gnu::noinline]] counted<int> middle(Exception exception)
+{
+    co_return co_await leaf(std::move(exception)) + 1;
+}
+
+std::size_t count_allocations(auto && function)
+{
+    auto before = counting_allocator::allocations;
+    function();
+    return counting_allocator::allocations - before;
+}
+
+}
+
+template <>
+struct zpp::define_exception<empty_tag>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<two_ints>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<tracked>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+TEST(inline_exception, empty_tag)
+{
+    EXPECT_EQ(count_allocations([] {
+        EXPECT_EQ(zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(empty_tag{});
+        }, [](const empty_tag &) {
+            return 1;
+        }, []() {
+            return -1;
+        }), 1);
+    }), 3u);
+}
+
+TEST(inline_exception, two_ints)
+{
+    EXPECT_EQ(count_allocations([] {
+        EXPECT_EQ(zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(two_ints{1, 2});
+        }, [](const two_ints & exception) {
+            return exception.first + exception.second;
+        }, []() {
+            return -1;
+        }), 3);
+    }), 3u);
+}
+
+TEST(inline_exception, standard_exception)
+{
+    EXPECT_EQ(count_allocations([] {
+        EXPECT_EQ(zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(std::runtime_error("Small."));
+        }, [](const std::runtime_error & error) {
+            EXPECT_STREQ(error.what(), "Small.");
+            return 1;
+        }, []() {
+            return -1;
+        }), 1);
+    }), 3u);
+}
+
+TEST(inline_exception, large_exception_is_allocated)
+{
+    EXPECT_EQ(count_allocations([] {
+        EXPECT_EQ(zpp::try_catch([]() -> counted<int> {
+            co_return co_await middle(
+                allocated<std::runtime_error>("Large."));
+        }, [](const std::runtime_error & error) {
+            EXPECT_STREQ(error.what(), "Large.");
+            return 1;
+        }, []() {
+            return -1;
+        }), 1);
+    }), 4u);
+}
+
+TEST(inline_exception, rethrow_destroys_once)
+{
+    int alive = 0;
+    EXPECT_EQ(zpp::try_catch([&]() -> counted<int> {
+        co_return co_await zpp::try_catch([&]() -> counted<int> {
+            co_return co_await middle(tracked{alive});
+        }, [&](const tracked &) -> counted<int> {
+            EXPECT_EQ(alive, 1);
+            co_yield zpp::rethrow;
+        });
+    }, [&](const tracked &) {
+        EXPECT_EQ(alive, 1);
+        return 1;
+    }, []() {
+        return -1;
+    }), 1);
+    EXPECT_EQ(alive, 0);
+}
@@ -0,0 +1,70 @@
+#include "test.h"
+
+namespace
+{
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, zpp::inline_frame_allocator<>>
+integer_divide(std::allocator_arg_t,
+               zpp::inline_frame_allocator<>,
+               int x,
+               int y)
+{
+    if (y == 0) {
+        co_yield std::overflow_error("Divide by zero!");
+    } else if (x % y != 0) {
+        co_yield std::range_error("Result is not an integer!");
+    }
+    co_return x / y;
+}
+
+template <std::size_t Size>
+int test_integer_divide(zpp::inline_frame<Size> & frame, int x, int y)
+{
+    return zpp::try_catch([&]() -> zpp::throwing<int> {
+        auto result =
+            co_await integer_divide(std::allocator_arg, frame, x, y);
+        EXPECT_FALSE(frame.in_use());
+        co_return result;
+    }, [&](const std::overflow_error &) {
+        return -1;
+    }, [&](const std::range_error &) {
+        return -2;
+    }, [&]() {
+        return -3;
+    });
+}
+
+[[gnu::noinline]] zpp::throwing<bool, zpp::inline_frame_allocator<>>
+check_in_use(std::allocator_arg_t,
+             zpp::inline_frame_allocator<>,
+             zpp::inline_frame<1024> & frame)
+{
+    co_return frame.in_use();
+}
+
+}
+
+TEST(inline_frame, integer_divide)
+{
+    zpp::inline_frame<1024> frame;
+    EXPECT_EQ(test_integer_divide(frame, 4, 2), 2);
+    EXPECT_EQ(test_integer_divide(frame, 4, 0), -1);
+    EXPECT_EQ(test_integer_divide(frame, 4, 3), -2);
+    EXPECT_FALSE(frame.in_use());
+}
+
+TEST(inline_frame, frame_in_storage)
+{
+    zpp::inline_frame<1024> frame;
+    EXPECT_TRUE(check_in_use(std::allocator_arg, frame, frame).value());
+    EXPECT_FALSE(frame.in_use());
+}
+
+TEST(inline_frame, fallback)
+{
+    zpp::inline_frame<1> frame;
+    EXPECT_EQ(test_integer_divide(frame, 4, 2), 2);
+    EXPECT_EQ(test_integer_divide(frame, 4, 0), -1);
+    EXPECT_FALSE(frame.in_use());
+}
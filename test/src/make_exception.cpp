@@ -0,0 +1,218 @@
+#include "test.h"
+
+namespace
+{
+
+struct counters
+{
+    int value{};
+    int constructions{};
+    int moves{};
+};
+
+struct counted
+{
+    counted(counters & counters, int value) : m_counters(&counters)
+    {
+        counters.value = value;
+        ++counters.constructions;
+    }
+
+    counted(counted && other) noexcept : m_counters(other.m_counters)
+    {
+        ++m_counters->moves;
+    }
+
+    int value() const
+    {
+        return m_counters->value;
+    }
+
+    counters * m_counters;
+};
+
+// Small enough to be stored inline, and large enough to be allocated.
+using small_counted = counted;
+
+struct large_counted : counted
+{
+    using counted::counted;
+
+    char padding[128]{};
+};
+
+struct immovable
+{
+    explicit immovable(int value) : m_value(value)
+    {
+    }
+
+    immovable(immovable &&) = delete;
+
+    int value() const
+    {
+        return m_value;
+    }
+
+    int m_value;
+};
+
+}
+
+template <>
+struct zpp::define_exception<counted>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<large_counted>
+{
+    using type = zpp::define_exception_bases<counted>;
+};
+
+template <>
+struct zpp::define_exception<immovable>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+namespace
+{
+
+template <typename Exception>
+zpp::throwing<int> fail(counters & counters, int value)
+{
+    co_yield zpp::make_exception<Exception>(counters, value);
+}
+
+template <typename Exception>
+int catch_value(auto && clause)
+{
+    return zpp::try_catch(clause, [](const Exception & exception) {
+        return exception.value();
+    }, []() {
+        return -1;
+    });
+}
+
+class arena_allocator
+{
+public:
+    using value_type = std::byte;
+
+    explicit arena_allocator(int & allocations) : m_allocations(&allocations)
+    {
+    }
+
+    std::byte * allocate(std::size_t size)
+    {
+        ++allocated;
+        ++*m_allocations;
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        --*m_allocations;
+        ::operator delete(pointer);
+    }
+
+    int * m_allocations{};
+
+    static inline int allocated{};
+};
+
+template <typename Exception>
+zpp::throwing<int, arena_allocator> arena_fail(std::allocator_arg_t,
+                                               const arena_allocator &,
+                                               counters & counters)
+{
+    co_yield zpp::make_exception<Exception>(counters, 1337);
+}
+
+// The number of allocations of throwing and catching the exception.
+template <typename Exception>
+int count_allocations(counters & counters)
+{
+    int allocations{};
+    auto before = arena_allocator::allocated;
+    EXPECT_EQ(catch_value<Exception>([&] {
+        return arena_fail<Exception>(
+            std::allocator_arg, arena_allocator{allocations}, counters);
+    }), 1337);
+    EXPECT_EQ(allocations, 0);
+    return arena_allocator::allocated - before;
+}
+
+}
+
+TEST(make_exception, allocated_without_move)
+{
+    counters counters;
+    EXPECT_EQ(catch_value<large_counted>([&] {
+        return fail<large_counted>(counters, 1337);
+    }), 1337);
+    EXPECT_EQ(counters.constructions, 1);
+    EXPECT_EQ(counters.moves, 0);
+}
+
+TEST(make_exception, inline_without_move)
+{
+    counters counters;
+    EXPECT_EQ(catch_value<small_counted>([&] {
+        return fail<small_counted>(counters, 1337);
+    }), 1337);
+    EXPECT_EQ(counters.constructions, 1);
+}
+
+TEST(make_exception, inline_is_not_allocated)
+{
+    counters small;
+    counters large;
+
+    // Only the large exception allocates its exception object.
+    EXPECT_EQ(count_allocations<small_counted>(small) + 1,
+              count_allocations<large_counted>(large));
+    EXPECT_EQ(small.constructions, 1);
+    EXPECT_EQ(large.moves, 0);
+}
+
+TEST(make_exception, immovable)
+{
+    EXPECT_EQ(catch_value<immovable>([]() -> zpp::throwing<int> {
+        co_yield zpp::make_exception<immovable>(1337);
+    }), 1337);
+}
+
+TEST(make_exception, standard_exception)
+{
+    EXPECT_EQ(zpp::try_catch([]() -> zpp::throwing<int> {
+        co_yield zpp::make_exception<std::runtime_error>("Error.");
+    }, [](const std::exception & error) {
+        return std::string_view(error.what()) == "Error.";
+    }, []() {
+        return false;
+    }), true);
+}
+
+TEST(make_exception, construct_result)
+{
+    counters counters;
+    EXPECT_EQ(catch_value<large_counted>([&]() -> zpp::throwing<int> {
+        return zpp::make_exception<large_counted>(counters, 1337);
+    }), 1337);
+    EXPECT_EQ(counters.moves, 0);
+}
+
+TEST(make_exception, allocator)
+{
+    counters counters;
+    int allocations{};
+    EXPECT_EQ(catch_value<large_counted>([&] {
+        return arena_fail<large_counted>(
+            std::allocator_arg, arena_allocator{allocations}, counters);
+    }), 1337);
+    EXPECT_EQ(counters.moves, 0);
+    EXPECT_EQ(allocations, 0);
+}
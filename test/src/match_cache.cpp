@@ -0,0 +1,124 @@
+#include "test.h"
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+template <int Index>
+struct derived_error : std::runtime_error
+{
+    derived_error() : std::runtime_error("Derived error.")
+    {
+    }
+};
+
+template <int Index>
+struct unrelated_error
+{
+};
+
+}
+
+template <int Index>
+struct zpp::define_exception<derived_error<Index>>
+{
+    using type = zpp::define_exception_bases<std::runtime_error>;
+};
+
+template <int Index>
+struct zpp::define_exception<unrelated_error<Index>>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+namespace
+{
+
+template <typename Exception>
+zpp::throwing<int> fail()
+{
+    co_yield Exception();
+}
+
+// A single catch site, such that all thrown types share its caches.
+int catch_site(zpp::throwing<int> (*function)())
+{
+    return zpp::try_catch([&] {
+        return function();
+    }, [](const std::runtime_error &) {
+        return 1;
+    }, [](const unrelated_error<0> &) {
+        return 2;
+    }, []() {
+        return 3;
+    });
+}
+
+// Another catch site, in which the same types match other clauses.
+int reversed_catch_site(zpp::throwing<int> (*function)())
+{
+    return zpp::try_catch([&] {
+        return function();
+    }, [](const unrelated_error<0> &) {
+        return 4;
+    }, [](const derived_error<0> &) {
+        return 5;
+    }, [](const std::exception &) {
+        return 6;
+    }, []() {
+        return 7;
+    });
+}
+
+// More thrown types than cache slots, so that they collide.
+int catch_all_types()
+{
+    return catch_site(fail<derived_error<0>>) +
+           10 * catch_site(fail<derived_error<1>>) +
+           100 * catch_site(fail<unrelated_error<0>>) +
+           1000 * catch_site(fail<unrelated_error<1>>) +
+           10000 * catch_site(fail<derived_error<2>>) +
+           100000 * catch_site(fail<unrelated_error<2>>);
+}
+
+}
+
+TEST(match_cache, repeated)
+{
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(catch_all_types(), 313211);
+    }
+}
+
+TEST(match_cache, catch_sites)
+{
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(catch_site(fail<derived_error<0>>), 1);
+        EXPECT_EQ(reversed_catch_site(fail<derived_error<0>>), 5);
+        EXPECT_EQ(catch_site(fail<derived_error<1>>), 1);
+        EXPECT_EQ(reversed_catch_site(fail<derived_error<1>>), 6);
+        EXPECT_EQ(catch_site(fail<unrelated_error<0>>), 2);
+        EXPECT_EQ(reversed_catch_site(fail<unrelated_error<0>>), 4);
+        EXPECT_EQ(reversed_catch_site(fail<unrelated_error<1>>), 7);
+    }
+}
+
+TEST(match_cache, threads)
+{
+    std::atomic<int> mismatches{};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 1000; ++j) {
+                if (catch_all_types() != 313211) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+}
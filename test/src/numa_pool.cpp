@@ -0,0 +1,90 @@
+#include "test.h"
+#include "zpp_throwing_allocators.h"
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+using numa = zpp::numa_pool_allocator;
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, numa> numa_divide(int x, int y)
+{
+    if (y == 0) {
+        co_yield allocated<std::overflow_error>("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+struct result_holder
+{
+    zpp::throwing<int, numa> result;
+};
+
+}
+
+TEST(numa_pool, allocates_from_current_node)
+{
+    numa allocator;
+    numa::simulate_node(1);
+    auto block = allocator.allocate(100);
+    EXPECT_EQ(numa::node_of(block), 1u);
+    allocator.deallocate(block, 100);
+
+    auto before = numa::statistics(1);
+    EXPECT_EQ(zpp::try_catch([] {
+        return numa_divide(8, 0);
+    }, [](const std::overflow_error &) {
+        return -1;
+    }, []() {
+        return -2;
+    }), -1);
+    numa::clear_simulated_node();
+    EXPECT_EQ(numa::statistics(1).cross_node_frees,
+              before.cross_node_frees);
+}
+
+TEST(numa_pool, block_returns_to_its_node)
+{
+    numa allocator;
+    numa::simulate_node(2);
+    auto block = allocator.allocate(100);
+
+    numa::simulate_node(3);
+    auto before = numa::statistics(2);
+    allocator.deallocate(block, 100);
+    EXPECT_EQ(numa::statistics(2).cross_node_frees -
+                  before.cross_node_frees,
+              1u);
+
+    numa::simulate_node(2);
+    EXPECT_EQ(allocator.allocate(100), block);
+    allocator.deallocate(block, 100);
+    numa::clear_simulated_node();
+}
+
+TEST(numa_pool, exception_caught_on_other_node)
+{
+    std::unique_ptr<result_holder> holder;
+    std::thread([&] {
+        numa::simulate_node(4);
+        holder.reset(new result_holder{numa_divide(8, 0)});
+    }).join();
+
+    numa::simulate_node(5);
+    auto before = numa::statistics(4);
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int, numa> {
+        auto & result = holder->result;
+        co_return co_await result;
+    }, [](const std::overflow_error & error) {
+        EXPECT_STREQ(error.what(), "Divide by zero!");
+        return -1;
+    }, []() {
+        return -2;
+    }), -1);
+    numa::clear_simulated_node();
+    EXPECT_EQ(numa::statistics(4).cross_node_frees -
+                  before.cross_node_frees,
+              1u);
+}
@@ -0,0 +1,158 @@
+#include "test.h"
+
+#ifdef __cpp_lib_memory_resource
+
+namespace
+{
+
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocations{};
+    std::size_t deallocations{};
+    std::size_t bytes{};
+
+private:
+    void * do_allocate(std::size_t size, std::size_t alignment) override
+    {
+        ++allocations;
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+
+    void do_deallocate(void * pointer,
+                       std::size_t size,
+                       std::size_t alignment) override
+    {
+        ++deallocations;
+        bytes -= size;
+        std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::pmr::throwing<int>
+pmr_divide(std::allocator_arg_t, std::pmr::memory_resource *, int x, int y)
+{
+    if (y == 0) {
+        co_yield allocated<std::overflow_error>("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+[[gnu::noinline]] zpp::pmr::throwing<int>
+pmr_divide_twice(std::allocator_arg_t,
+                 std::pmr::memory_resource * resource,
+                 int x,
+                 int y)
+{
+    auto result = co_await pmr_divide(std::allocator_arg, resource, x, y);
+    co_return co_await pmr_divide(std::allocator_arg, resource, result, y);
+}
+
+// Returns the misalignment of a local that lives in the frame.
+[[gnu::noinline]] zpp::pmr::throwing<std::size_t>
+pmr_frame_misalignment(std::allocator_arg_t,
+                       std::pmr::memory_resource * resource)
+{
+    alignas(std::max_align_t) std::byte local[1]{};
+    co_await pmr_divide(std::allocator_arg, resource, 1, 1);
+    co_return reinterpret_cast<std::uintptr_t>(local) %
+        alignof(std::max_align_t);
+}
+
+}
+
+TEST(pmr, success)
+{
+    counting_resource resource;
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return pmr_divide_twice(std::allocator_arg, &resource, 8, 2);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    }), 2);
+
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+    EXPECT_EQ(resource.bytes, 0u);
+}
+
+TEST(pmr, exception_from_resource)
+{
+    counting_resource resource;
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return pmr_divide_twice(std::allocator_arg, &resource, 8, 0);
+    }, [&](const std::overflow_error & error) {
+        EXPECT_STREQ(error.what(), "Divide by zero!");
+        EXPECT_EQ(resource.allocations - resource.deallocations, 1u);
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+    EXPECT_EQ(resource.bytes, 0u);
+}
+
+TEST(pmr, monotonic_buffer_resource)
+{
+    counting_resource upstream;
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource resource(
+        buffer, sizeof(buffer), &upstream);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(zpp::try_catch([&] {
+            return pmr_divide_twice(std::allocator_arg, &resource, 8, 0);
+        }, [&](const std::overflow_error &) {
+            return 1;
+        }, []() {
+            return -2;
+        }), 1);
+    }
+
+    EXPECT_EQ(upstream.allocations, 0u);
+}
+
+TEST(pmr, misaligned_monotonic_buffer_resource)
+{
+    alignas(std::max_align_t) std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource resource(
+        buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    // Misalign the arena.
+    (void)resource.allocate(1, 1);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(zpp::try_catch([&] {
+            return pmr_frame_misalignment(std::allocator_arg, &resource);
+        }, []() {
+            return std::size_t(-1);
+        }), 0u);
+
+        EXPECT_EQ(zpp::try_catch([&] {
+            return pmr_divide_twice(std::allocator_arg, &resource, 8, 0);
+        }, [&](const std::overflow_error & error) {
+            // The remainder is less than the alignment, and fits an int.
+            return static_cast<int>(
+                reinterpret_cast<std::uintptr_t>(&error) %
+                alignof(std::overflow_error));
+        }, []() {
+            return -1;
+        }), 0);
+
+        // Misalign the arena again.
+        (void)resource.allocate(1, 1);
+    }
+}
+
+#endif
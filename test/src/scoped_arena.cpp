@@ -0,0 +1,115 @@
+#include "test.h"
+
+namespace
+{
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, zpp::scoped_arena_allocator>
+arena_divide(int x, int y)
+{
+    if (y == 0) {
+        co_yield allocated<std::overflow_error>("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+[[gnu::noinline]] zpp::throwing<int, zpp::scoped_arena_allocator>
+arena_divide_twice(int x, int y)
+{
+    auto result = co_await arena_divide(x, y);
+    co_return co_await arena_divide(result, y);
+}
+
+}
+
+TEST(scoped_arena, success)
+{
+    auto before = zpp::scoped_arena::statistics();
+
+    EXPECT_EQ(zpp::arena_try_catch([] {
+        return arena_divide_twice(8, 2);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    }), 2);
+
+    auto after = zpp::scoped_arena::statistics();
+    EXPECT_GE(after.arena_allocations - before.arena_allocations, 3u);
+    EXPECT_EQ(after.heap_allocations, before.heap_allocations);
+    EXPECT_EQ(after.resets - before.resets, 1u);
+}
+
+TEST(scoped_arena, exception)
+{
+    auto before = zpp::scoped_arena::statistics();
+
+    EXPECT_EQ(zpp::arena_try_catch([] {
+        return arena_divide_twice(8, 0);
+    }, [](const std::overflow_error & error) {
+        EXPECT_STREQ(error.what(), "Divide by zero!");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+
+    auto after = zpp::scoped_arena::statistics();
+    EXPECT_GE(after.arena_allocations - before.arena_allocations, 3u);
+    EXPECT_EQ(after.heap_allocations, before.heap_allocations);
+    EXPECT_EQ(after.resets - before.resets, 1u);
+}
+
+TEST(scoped_arena, nested)
+{
+    auto before = zpp::scoped_arena::statistics();
+
+    EXPECT_EQ(zpp::arena_try_catch([]()
+                  -> zpp::throwing<int, zpp::scoped_arena_allocator> {
+        co_return co_await zpp::try_catch([] {
+            return arena_divide_twice(8, 0);
+        }, [](const std::overflow_error &)
+               -> zpp::throwing<int, zpp::scoped_arena_allocator> {
+            co_return co_await arena_divide(8, 4);
+        });
+    }, []() {
+        return -2;
+    }), 2);
+
+    // Only the outermost scope resets the arena.
+    auto after = zpp::scoped_arena::statistics();
+    EXPECT_EQ(after.heap_allocations, before.heap_allocations);
+    EXPECT_EQ(after.resets - before.resets, 1u);
+}
+
+TEST(scoped_arena, nested_scope)
+{
+    auto before = zpp::scoped_arena::statistics();
+
+    EXPECT_EQ(zpp::arena_try_catch([]()
+                  -> zpp::throwing<int, zpp::scoped_arena_allocator> {
+        auto result = zpp::arena_try_catch([] {
+            return arena_divide_twice(8, 0);
+        }, [](const std::overflow_error &) {
+            return 1;
+        }, []() {
+            return -1;
+        });
+        co_return result + co_await arena_divide(8, 4);
+    }, []() {
+        return -2;
+    }), 3);
+
+    // Only the outermost scope resets the arena.
+    auto after = zpp::scoped_arena::statistics();
+    EXPECT_EQ(after.heap_allocations, before.heap_allocations);
+    EXPECT_EQ(after.resets - before.resets, 1u);
+}
+
+TEST(scoped_arena, without_scope)
+{
+    auto before = zpp::scoped_arena::statistics();
+    EXPECT_EQ(arena_divide(8, 2).value(), 4);
+    auto after = zpp::scoped_arena::statistics();
+    EXPECT_EQ(after.heap_allocations - before.heap_allocations, 1u);
+    EXPECT_EQ(after.arena_allocations, before.arena_allocations);
+}
@@ -0,0 +1,134 @@
+#include "test.h"
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct tracked
+{
+    explicit tracked(std::atomic<int> & alive) : alive(&alive)
+    {
+        ++alive;
+    }
+
+    tracked(tracked && other) noexcept : alive(other.alive)
+    {
+        ++*alive;
+    }
+
+    ~tracked()
+    {
+        --*alive;
+    }
+
+    std::atomic<int> * alive;
+};
+
+// Small enough to be stored inline, and large enough to be allocated.
+using small_tracked = tracked;
+
+struct large_tracked : tracked
+{
+    using tracked::tracked;
+
+    char padding[128]{};
+};
+
+template <typename Exception>
+zpp::throwing<int> fail(std::atomic<int> & alive)
+{
+    co_yield Exception(alive);
+}
+
+template <typename Exception>
+int catch_result(zpp::throwing<int> && result)
+{
+    return zpp::try_catch([&] {
+        return std::move(result);
+    }, [](const Exception &) {
+        return 1;
+    }, []() {
+        return -1;
+    });
+}
+
+}
+
+template <>
+struct zpp::define_exception<tracked>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<large_tracked>
+{
+    using type = zpp::define_exception_bases<tracked>;
+};
+
+TEST(shared_exception, allocated)
+{
+    std::atomic<int> alive{};
+    auto result = fail<large_tracked>(alive);
+    auto first = result.share();
+    auto second = first.share();
+    EXPECT_EQ(alive, 1);
+
+    EXPECT_EQ(catch_result<large_tracked>(std::move(result)), 1);
+    EXPECT_EQ(catch_result<large_tracked>(std::move(first)), 1);
+    EXPECT_EQ(alive, 1);
+    EXPECT_EQ(catch_result<large_tracked>(std::move(second)), 1);
+    EXPECT_EQ(alive, 0);
+}
+
+TEST(shared_exception, inline_moved_to_heap)
+{
+    std::atomic<int> alive{};
+    auto result = fail<small_tracked>(alive);
+    auto copy = result.share();
+    EXPECT_EQ(alive, 1);
+
+    EXPECT_EQ(catch_result<small_tracked>(std::move(copy)), 1);
+    EXPECT_EQ(alive, 1);
+    EXPECT_EQ(catch_result<small_tracked>(std::move(result)), 1);
+    EXPECT_EQ(alive, 0);
+}
+
+TEST(shared_exception, value_and_error)
+{
+    zpp::throwing<int> value = 1337;
+    EXPECT_EQ(value.share().value(), 1337);
+
+    zpp::throwing<int> error = std::errc::invalid_argument;
+    EXPECT_EQ(zpp::try_catch([&] {
+        return error.share();
+    }, [](std::errc code) {
+        return int(code);
+    }, []() {
+        return -1;
+    }), int(std::errc::invalid_argument));
+}
+
+TEST(shared_exception, waiters_on_threads)
+{
+    std::atomic<int> alive{};
+    std::atomic<int> caught{};
+    auto result = fail<large_tracked>(alive);
+
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 8; ++i) {
+        waiters.emplace_back(
+            [&caught, copy = result.share()]() mutable {
+                caught += catch_result<large_tracked>(std::move(copy));
+            });
+    }
+    for (auto & waiter : waiters) {
+        waiter.join();
+    }
+    EXPECT_EQ(caught, 8);
+    EXPECT_EQ(alive, 1);
+
+    EXPECT_EQ(catch_result<large_tracked>(std::move(result)), 1);
+    EXPECT_EQ(alive, 0);
+}
@@ -0,0 +1,128 @@
+#include "test.h"
+
+namespace
+{
+
+struct arena
+{
+    std::size_t allocations{};
+    std::size_t deallocations{};
+    std::size_t bytes{};
+};
+
+class arena_allocator
+{
+public:
+    using value_type = std::byte;
+
+    explicit arena_allocator(arena & arena) : m_arena(&arena)
+    {
+    }
+
+    std::byte * allocate(std::size_t size)
+    {
+        ++m_arena->allocations;
+        m_arena->bytes += size;
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        ++m_arena->deallocations;
+        m_arena->bytes -= size;
+        ::operator delete(pointer);
+    }
+
+    arena * m_arena{};
+};
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, arena_allocator>
+arena_divide(std::allocator_arg_t, const arena_allocator &, int x, int y)
+{
+    if (y == 0) {
+        co_yield allocated<std::overflow_error>("Divide by zero!");
+    }
+    co_return x / y;
+}
+
+[[gnu::noinline]] zpp::throwing<int, arena_allocator>
+arena_divide_twice(std::allocator_arg_t,
+                   const arena_allocator & allocator,
+                   int x,
+                   int y)
+{
+    auto result = co_await arena_divide(std::allocator_arg, allocator, x, y);
+    co_return co_await arena_divide(std::allocator_arg, allocator, result, y);
+}
+
+struct arena_divider
+{
+    [[gnu::noinline]] zpp::throwing<int, arena_allocator>
+    divide(std::allocator_arg_t, const arena_allocator & allocator, int x)
+    {
+        co_return co_await arena_divide(
+            std::allocator_arg, allocator, x, divisor);
+    }
+
+    int divisor{};
+};
+
+}
+
+TEST(stateful_allocator, success)
+{
+    arena arena;
+    arena_allocator allocator{arena};
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return arena_divide_twice(std::allocator_arg, allocator, 8, 2);
+    }, [](const std::exception &) {
+        return -1;
+    }, []() {
+        return -2;
+    }), 2);
+
+    EXPECT_EQ(arena.allocations, arena.deallocations);
+    EXPECT_EQ(arena.bytes, 0u);
+}
+
+TEST(stateful_allocator, exception_from_arena)
+{
+    arena arena;
+    arena_allocator allocator{arena};
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return arena_divide_twice(std::allocator_arg, allocator, 8, 0);
+    }, [&](const std::overflow_error & error) {
+        EXPECT_STREQ(error.what(), "Divide by zero!");
+
+        // Frames are destroyed, only the exception is alive.
+        EXPECT_EQ(arena.allocations - arena.deallocations, 1u);
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+
+    EXPECT_EQ(arena.allocations, arena.deallocations);
+    EXPECT_EQ(arena.bytes, 0u);
+}
+
+TEST(stateful_allocator, member_function)
+{
+    arena arena;
+    arena_allocator allocator{arena};
+    arena_divider divider{0};
+
+    EXPECT_EQ(zpp::try_catch([&] {
+        return divider.divide(std::allocator_arg, allocator, 8);
+    }, [&](const std::overflow_error &) {
+        EXPECT_EQ(arena.allocations - arena.deallocations, 1u);
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+
+    EXPECT_EQ(arena.allocations, arena.deallocations);
+    EXPECT_EQ(arena.bytes, 0u);
+}
@@ -0,0 +1,79 @@
+#include "test.h"
+
+namespace
+{
+
+zpp::throwing<int> find(int key)
+{
+    if (key < 0) {
+        co_yield zpp::static_out_of_range("Key not found!");
+    }
+    co_return key;
+}
+
+}
+
+TEST(static_error, catch_by_base)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await find(-1);
+    }, [](const zpp::static_runtime_error &) {
+        return -1;
+    }, [](const zpp::static_logic_error & error) {
+        EXPECT_EQ(error.message(), "Key not found!");
+        EXPECT_STREQ(error.what(), "Key not found!");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+
+TEST(static_error, catch_as_std_exception)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await find(-1);
+    }, [](const std::exception & error) {
+        EXPECT_STREQ(error.what(), "Key not found!");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
+
+TEST(static_error, reused)
+{
+    using cache = zpp::exception_cache<zpp::static_out_of_range>;
+
+    for (int i = 0; i < 2; ++i) {
+        zpp::try_catch([&]() -> zpp::throwing<int> {
+            co_return co_await find(-1);
+        }, [](const zpp::static_error &) {
+            return 1;
+        }, []() {
+            return -2;
+        });
+    }
+
+    EXPECT_GE(cache::statistics().reused, 1u);
+}
+
+TEST(static_error, message_shorter_than_array)
+{
+    static constexpr char message[16] = "Short";
+    zpp::static_runtime_error error(message);
+    EXPECT_EQ(error.message(), "Short");
+    EXPECT_EQ(error.message().size(), 5u);
+}
+
+TEST(static_error, make_exception)
+{
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_yield zpp::make_exception<zpp::static_out_of_range>(
+            zpp::static_message("Key not found!"));
+    }, [](const zpp::static_logic_error & error) {
+        EXPECT_EQ(error.message(), "Key not found!");
+        return 1;
+    }, []() {
+        return -2;
+    }), 1);
+}
@@ -0,0 +1,217 @@
+#include "test.h"
+
+namespace
+{
+
+struct parse_error
+{
+    explicit parse_error(int position) : position(position)
+    {
+    }
+
+    int position;
+};
+
+struct overflow_error : parse_error
+{
+    using parse_error::parse_error;
+};
+
+struct tracked
+{
+    explicit tracked(int & destructions) : destructions(&destructions)
+    {
+    }
+
+    tracked(tracked && other) noexcept :
+        destructions(std::exchange(other.destructions, nullptr))
+    {
+    }
+
+    ~tracked()
+    {
+        if (destructions) {
+            ++*destructions;
+        }
+    }
+
+    int * destructions;
+};
+
+}
+
+template <>
+struct zpp::define_exception<parse_error>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+template <>
+struct zpp::define_exception<overflow_error>
+{
+    using type = zpp::define_exception_bases<parse_error>;
+};
+
+template <>
+struct zpp::define_exception<tracked>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+namespace
+{
+
+using parse_result =
+    zpp::throwing<int, zpp::throws<parse_error, overflow_error, std::errc>>;
+
+parse_result parse(int input)
+{
+    if (input < 0) {
+        co_yield parse_error(-input);
+    }
+    if (input > 1000) {
+        co_yield overflow_error(input);
+    }
+    if (input == 0) {
+        co_yield std::errc::invalid_argument;
+    }
+    co_return input * 2;
+}
+
+parse_result parse_twice(int first, int second)
+{
+    co_return co_await parse(first) + co_await parse(second);
+}
+
+int catch_parse(auto && clause)
+{
+    return zpp::try_catch(clause, [](const overflow_error & error) {
+        return -error.position;
+    }, [](const parse_error & error) {
+        return error.position;
+    }, [](std::errc error) {
+        return int(error);
+    });
+}
+
+}
+
+TEST(static_exceptions, value)
+{
+    EXPECT_EQ(catch_parse([] { return parse(21); }), 42);
+}
+
+TEST(static_exceptions, exception)
+{
+    EXPECT_EQ(catch_parse([] { return parse(-5); }), 5);
+}
+
+TEST(static_exceptions, derived_exception_first_clause)
+{
+    EXPECT_EQ(catch_parse([] { return parse(2000); }), -2000);
+}
+
+TEST(static_exceptions, base_clause)
+{
+    EXPECT_EQ(zpp::try_catch([] { return parse(2000); },
+                             [](const parse_error & error) {
+                                 return error.position;
+                             },
+                             []() { return -1; }),
+              2000);
+}
+
+TEST(static_exceptions, error_code)
+{
+    EXPECT_EQ(catch_parse([] { return parse(0); }),
+              int(std::errc::invalid_argument));
+}
+
+TEST(static_exceptions, error_clause)
+{
+    EXPECT_EQ(zpp::try_catch([] { return parse(0); },
+                             [](const zpp::error & error) {
+                                 return error.code();
+                             },
+                             []() { return -1; }),
+              int(std::errc::invalid_argument));
+}
+
+TEST(static_exceptions, propagate)
+{
+    EXPECT_EQ(catch_parse([] { return parse_twice(1, 2); }), 6);
+    EXPECT_EQ(catch_parse([] { return parse_twice(1, -7); }), 7);
+    EXPECT_EQ(catch_parse([] { return parse_twice(1001, -7); }), -1001);
+}
+
+TEST(static_exceptions, propagate_subset)
+{
+    EXPECT_EQ(catch_parse([]() -> parse_result {
+        co_return co_await []() -> zpp::throwing<int, zpp::throws<std::errc>> {
+            co_yield std::errc::result_out_of_range;
+        }();
+    }), int(std::errc::result_out_of_range));
+}
+
+TEST(static_exceptions, convert_to_erased)
+{
+    auto erased = [](int input) -> zpp::throwing<int> {
+        co_return co_await parse(input) + 1;
+    };
+
+    auto catch_erased = [](auto && clause) {
+        return zpp::try_catch(clause, [](const parse_error & error) {
+            return error.position;
+        }, [](std::errc error) {
+            return int(error) + 1000;
+        }, []() {
+            return -1;
+        });
+    };
+
+    EXPECT_EQ(catch_erased([&] { return erased(3); }), 7);
+    EXPECT_EQ(catch_erased([&] { return erased(-9); }), 9);
+    EXPECT_EQ(catch_erased([&] { return erased(5000); }), 5000);
+    EXPECT_EQ(catch_erased([&] { return erased(0); }),
+              int(std::errc::invalid_argument) + 1000);
+}
+
+TEST(static_exceptions, void_result)
+{
+    bool caught = false;
+    zpp::try_catch([]() -> zpp::throwing<void, zpp::throws<parse_error>> {
+        co_yield parse_error(1);
+    }, [&](const parse_error &) {
+        caught = true;
+    });
+    EXPECT_TRUE(caught);
+
+    caught = false;
+    zpp::try_catch([]() -> zpp::throwing<void, zpp::throws<parse_error>> {
+        co_return;
+    }, [&]() {
+        caught = true;
+    });
+    EXPECT_FALSE(caught);
+}
+
+TEST(static_exceptions, destruction)
+{
+    int destructions{};
+    zpp::try_catch([&]() -> zpp::throwing<void, zpp::throws<tracked>> {
+        co_yield tracked(destructions);
+    }, []() {});
+    EXPECT_EQ(destructions, 1);
+
+    destructions = 0;
+    EXPECT_EQ(zpp::try_catch([&]() -> zpp::throwing<int> {
+        co_return co_await [&]() -> zpp::throwing<int, zpp::throws<tracked>> {
+            co_yield tracked(destructions);
+        }();
+    }, [](const tracked &) {
+        return 0;
+    }, []() {
+        return -1;
+    }), 0);
+    EXPECT_EQ(destructions, 1);
+}
@@ -0,0 +1,142 @@
+#include "test.h"
+
+namespace
+{
+
+struct chain_pool_tag;
+using chain_pool = zpp::static_pool_allocator<2048, 2, chain_pool_tag>;
+
+// Not inlined so that the frame allocation is not elided.
+[[gnu::noinline]] zpp::throwing<int, chain_pool> chain(int depth)
+{
+    if (!depth) {
+        co_return 0;
+    }
+    co_return 1 + co_await chain(depth - 1);
+}
+
+struct exception_pool_tag;
+using exception_pool = zpp::static_pool_allocator<2048, 1, exception_pool_tag>;
+
+[[gnu::noinline]] zpp::throwing<int, exception_pool> throw_exception()
+{
+    co_yield allocated<std::runtime_error>("My runtime error!");
+}
+
+}
+
+TEST(static_pool, success)
+{
+    EXPECT_EQ(chain(1).value(), 1);
+    EXPECT_EQ(chain_pool::in_use(), 0u);
+    EXPECT_EQ(chain_pool::high_water_mark(), 2u);
+}
+
+TEST(static_pool, exhausted)
+{
+    EXPECT_EQ(zpp::try_catch([] {
+        return chain(2);
+    }, [](std::errc error) {
+        EXPECT_EQ(error, std::errc::not_enough_memory);
+        return -1;
+    }, []() {
+        return -2;
+    }), -1);
+    EXPECT_EQ(chain_pool::in_use(), 0u);
+    EXPECT_EQ(chain_pool::high_water_mark(), 2u);
+}
+
+TEST(static_pool, exception_exhausted)
+{
+    // The frame takes the only block, the exception can not be allocated
+    // from the pool and is held by the emergency buffer.
+    EXPECT_EQ(zpp::try_catch([] {
+        return throw_exception();
+    }, [](const std::runtime_error &) {
+        EXPECT_EQ(zpp::emergency_exception_buffer::in_use(), 1u);
+        return 1;
+    }, [](std::errc) {
+        return -1;
+    }, []() {
+        return -2;
+    }), 1);
+    EXPECT_EQ(zpp::emergency_exception_buffer::in_use(), 0u);
+    EXPECT_EQ(exception_pool::in_use(), 0u);
+    EXPECT_EQ(exception_pool::high_water_mark(), 1u);
+}
+
+namespace
+{
+
+// Small enough to be stored inline.
+struct small_error
+{
+};
+
+}
+
+template <>
+struct zpp::define_exception<small_error>
+{
+    using type = zpp::define_exception_bases<>;
+};
+
+namespace
+{
+
+struct share_pool_tag;
+using share_pool = zpp::static_pool_allocator<2048, 2, share_pool_tag>;
+
+[[gnu::noinline]] zpp::throwing<int, share_pool> throw_small()
+{
+    co_yield small_error{};
+}
+
+int catch_small(zpp::throwing<int, share_pool> && result)
+{
+    return zpp::try_catch([&] {
+        return std::move(result);
+    }, [](const small_error &) {
+        return 1;
+    }, [](std::errc error) {
+        EXPECT_EQ(error, std::errc::not_enough_memory);
+        return -1;
+    }, []() {
+        return -2;
+    });
+}
+
+}
+
+TEST(static_pool, share_from_pool)
+{
+    // The frame is freed once the coroutine throws.
+    auto result = throw_small();
+    EXPECT_EQ(share_pool::in_use(), 0u);
+
+    // The inline exception is moved to the pool, not the global heap.
+    auto copy = result.share();
+    EXPECT_EQ(share_pool::in_use(), 1u);
+
+    EXPECT_EQ(catch_small(std::move(copy)), 1);
+    EXPECT_EQ(share_pool::in_use(), 1u);
+    EXPECT_EQ(catch_small(std::move(result)), 1);
+    EXPECT_EQ(share_pool::in_use(), 0u);
+}
+
+TEST(static_pool, share_exhausted)
+{
+    auto result = throw_small();
+    auto first = share_pool{}.allocate(1);
+    auto second = share_pool{}.allocate(1);
+
+    // The copy holds the allocation failure, and the original keeps its
+    // exception.
+    auto copy = result.share();
+    EXPECT_EQ(catch_small(std::move(copy)), -1);
+    EXPECT_EQ(catch_small(std::move(result)), 1);
+
+    share_pool{}.deallocate(second, 1);
+    share_pool{}.deallocate(first, 1);
+    EXPECT_EQ(share_pool::in_use(), 0u);
+}
@@ -1,15 +1,26 @@
 #ifndef ZPP_THROWING_H
 #define ZPP_THROWING_H
 
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <new>
 #include <exception>
+#include <iterator>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <system_error>
 #include <tuple>
 #include <type_traits>
+#include <utility>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 
 #if __has_include(<coroutine>)
 #include <coroutine>
@@ -17,6 +28,51 @@
 #include <experimental/coroutine>
 #endif
 
+/**
+ * Define `ZPP_THROWING_ELIDE_FRAMES` consistently in all translation units
+ * to opt-in to marking `zpp::throwing` with `[[clang::coro_await_elidable]]`
+ * where supported. The frame of a coroutine that is immediately awaited
+ * is then allocated within the frame of the awaiting coroutine, even when
+ * the called coroutine is not inlined into it.
+ */
+#if defined(ZPP_THROWING_ELIDE_FRAMES) && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::coro_await_elidable)
+#define ZPP_THROWING_CORO_AWAIT_ELIDABLE [[clang::coro_await_elidable]]
+#endif
+#endif
+
+#ifndef ZPP_THROWING_CORO_AWAIT_ELIDABLE
+#define ZPP_THROWING_CORO_AWAIT_ELIDABLE
+#endif
+
+/**
+ * The size and alignment of exceptions that are held within the exit
+ * condition of a coroutine without allocating. The storage also holds
+ * the header of the exception object, three pointers, in addition to
+ * the size. Exceptions that do not fit, or are not nothrow move
+ * constructible, are allocated. Inline exceptions are moved at every
+ * level they propagate through, hence larger sizes trade allocations
+ * for moves. Define consistently in all translation units, size zero
+ * disables the inline storage.
+ */
+#ifndef ZPP_THROWING_INLINE_EXCEPTION_SIZE
+#define ZPP_THROWING_INLINE_EXCEPTION_SIZE (2 * sizeof(void *))
+#endif
+
+#ifndef ZPP_THROWING_INLINE_EXCEPTION_ALIGNMENT
+#define ZPP_THROWING_INLINE_EXCEPTION_ALIGNMENT alignof(void *)
+#endif
+
+/**
+ * Define `ZPP_THROWING_CHECK_ARENAS` to count the live allocations of
+ * `zpp::scoped_arena` and terminate when any outlives the outermost
+ * scope. Defined by default unless `NDEBUG` is defined, otherwise
+ * freeing memory of an installed arena does nothing at all.
+ */
+#if !defined(ZPP_THROWING_CHECK_ARENAS) && !defined(NDEBUG)
+#define ZPP_THROWING_CHECK_ARENAS
+#endif
+
 namespace zpp
 {
 /**
@@ -311,781 +367,4589 @@ struct dynamic_object
     void * address{};
 };
 
+namespace detail
+{
 /**
- * Exception object type erasure.
+ * A segment of the context messages of an exception object, in the
+ * order they were attached. Segments have a fixed capacity and are
+ * linked rather than grown, so that attaching a message never copies
+ * the previous ones and takes at most one allocation, and each thread
+ * keeps a few freed segments for reuse, so that a chain usually takes
+ * none. The first segment holds the number of messages and the last
+ * segment, to which messages are appended.
  */
-class exception_object
+struct error_context_block
 {
-public:
-    virtual struct dynamic_object dynamic_object() noexcept = 0;
-    virtual ~exception_object() = 0;
+    static constexpr std::uint32_t capacity = 14;
+    static constexpr std::size_t cached_segments = 4;
 
-    static constexpr struct dynamic_object null_dynamic_object = {};
-};
+    /**
+     * Appends the message to the segments starting at `first`, which may
+     * be null, and returns the first segment. The message is dropped if
+     * no memory is available.
+     */
+    static error_context_block * append(error_context_block * first,
+                                        std::string_view message) noexcept
+    {
+        auto last = first ? first->last : nullptr;
+        if (!last || last->count == capacity) {
+            auto segment = allocate();
+            if (!segment) [[unlikely]] {
+                return first;
+            }
+            if (last) {
+                last->next = segment;
+            } else {
+                first = segment;
+            }
+            first->last = last = segment;
+        }
+        last->messages[last->count++] = message;
+        ++first->size;
+        return first;
+    }
+
+    /**
+     * Frees the segments starting at `first`, or keeps them for reuse by
+     * the current thread.
+     */
+    static void release(error_context_block * first) noexcept
+    {
+        auto & cache = local_cache();
+        while (first) {
+            auto next = first->next;
+            if (cache.count < cached_segments) {
+                first->next = cache.segments;
+                cache.segments = first;
+                ++cache.count;
+            } else {
+                delete first;
+            }
+            first = next;
+        }
+    }
 
-inline exception_object::~exception_object() = default;
+    error_context_block * next{};
+    error_context_block * last{};
+    std::uint32_t size{};
+    std::uint32_t count{};
+    std::string_view messages[capacity];
 
-/**
- * Define base classes for a particular exception.
- */
-template <typename... Bases>
-struct define_exception_bases
-{
+private:
+    static error_context_block * allocate() noexcept
+    {
+        auto & cache = local_cache();
+        if (auto segment = cache.segments) {
+            cache.segments = segment->next;
+            --cache.count;
+            return ::new (static_cast<void *>(segment)) error_context_block{};
+        }
+        return new (std::nothrow) error_context_block{};
+    }
+
+    struct cache
+    {
+        ~cache()
+        {
+            while (segments) {
+                delete std::exchange(segments, segments->next);
+            }
+        }
+
+        error_context_block * segments;
+        std::size_t count;
+    };
+
+    static cache & local_cache() noexcept
+    {
+        static thread_local cache cache{};
+        return cache;
+    }
 };
+} // namespace detail
 
 /**
- * Define an exception to be supported by the framework.
- * ```cpp
- * template<>
- * struct zpp::define_exception<my_exception>
- * {
- *     using type = zpp::define_exception_bases<exception_base_1,
- * exception_base_2>;
- * };
- * ```
+ * The context messages attached to an exception as it propagated, from
+ * the innermost to the outermost, see `zpp::current_error_context()`.
  */
-template <typename Type>
-struct define_exception;
-
-template <typename Type>
-using define_exception_t = typename define_exception<Type>::type;
-
-template <typename Allocator>
-struct exception_object_delete
+class error_context
 {
-    void operator()(exception_object * pointer)
+public:
+    class iterator
     {
-        if constexpr (std::is_void_v<Allocator>) {
-            delete pointer;
-        } else {
-            Allocator allocator;
-            std::allocator_traits<Allocator>::destroy(allocator, pointer);
-            std::allocator_traits<Allocator>::deallocate(
-                allocator, reinterpret_cast<std::byte *>(pointer), 0);
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view *;
+        using reference = const std::string_view &;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr explicit iterator(
+            const detail::error_context_block * segment) noexcept :
+            m_segment(segment)
+        {
         }
-    }
-};
 
-template <typename Allocator>
-using exception_ptr =
-    std::unique_ptr<exception_object, exception_object_delete<Allocator>>;
+        constexpr reference operator*() const noexcept
+        {
+            return m_segment->messages[m_index];
+        }
 
-template <typename Type, typename Allocator>
-auto make_exception_object(auto &&... arguments)
-{
-    if constexpr (std::is_void_v<Allocator>) {
-        return static_cast<exception_object *>(
-            new Type(std::forward<decltype(arguments)>(arguments)...));
-    } else {
-        Allocator allocator;
-        auto allocated = std::allocator_traits<Allocator>::allocate(
-            allocator, sizeof(Type));
-        if (!allocated) {
-            return static_cast<exception_object *>(nullptr);
+        constexpr pointer operator->() const noexcept
+        {
+            return m_segment->messages + m_index;
         }
 
-        std::allocator_traits<Allocator>::construct(
-            allocator,
-            reinterpret_cast<Type *>(allocated),
-            std::forward<decltype(arguments)>(arguments)...);
+        constexpr iterator & operator++() noexcept
+        {
+            // Only the last segment is not full.
+            if (++m_index == m_segment->count) {
+                m_segment = m_segment->next;
+                m_index = 0;
+            }
+            return *this;
+        }
 
-        return static_cast<exception_object *>(
-            reinterpret_cast<Type *>(allocated));
-    }
-}
+        constexpr iterator operator++(int) noexcept
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
 
-namespace detail
-{
-union type_info_entry
-{
-    constexpr type_info_entry(std::size_t number) : number(number)
+        friend constexpr bool operator==(const iterator &,
+                                         const iterator &) = default;
+
+    private:
+        const detail::error_context_block * m_segment{};
+        std::uint32_t m_index{};
+    };
+
+    constexpr error_context() noexcept = default;
+
+    explicit error_context(detail::error_context_block * first) noexcept :
+        m_first(first)
     {
     }
 
-    constexpr type_info_entry(const void * pointer) : pointer(pointer)
+    constexpr iterator begin() const noexcept
     {
+        return iterator{m_first};
     }
 
-    constexpr type_info_entry(void * (*function)(void *) noexcept) :
-        function(function)
+    constexpr iterator end() const noexcept
     {
+        return iterator{};
     }
 
-    std::size_t number;
-    const void * pointer;
-    void * (*function)(void *);
-};
-
-template <typename Source, typename Destination>
-void * erased_static_cast(void * source) noexcept
-{
-    return static_cast<Destination *>(static_cast<Source *>(source));
-}
-
-template <typename Source, typename Destination>
-constexpr auto make_erased_static_cast() noexcept
-{
-    return &erased_static_cast<Source, Destination>;
-}
+    constexpr std::size_t size() const noexcept
+    {
+        return m_first ? m_first->size : 0;
+    }
 
-template <typename Type>
-constexpr auto type_id() noexcept -> const void *;
+    constexpr bool empty() const noexcept
+    {
+        return !m_first;
+    }
 
-template <typename Type, typename... Bases>
-struct type_information
-{
-    static_assert((... && std::is_base_of_v<Bases, Type>),
-                  "Bases must be base classes of Type.");
+    constexpr std::string_view operator[](std::size_t index) const noexcept
+    {
+        auto segment = m_first;
+        while (index >= segment->count) {
+            index -= segment->count;
+            segment = segment->next;
+        }
+        return segment->messages[index];
+    }
 
-    // Construct the type information.
-    static constexpr type_info_entry info[] = {
-        sizeof...(Bases),    // Number of source classes.
-        type_id<Bases>()..., // Source classes type information.
-        make_erased_static_cast<Type,
-                                Bases>()..., // Casts from derived to
-                                             // base.
-    };
+private:
+    const detail::error_context_block * m_first{};
 };
 
-template <typename Type>
-struct type_information<Type>
+/**
+ * Exception object type erasure. The header stores the type id and
+ * offset of the exception, so that catching reads them without an
+ * indirect call, a reference count for exception objects that are
+ * shared between results, and a single function that manages the
+ * object. Objects that are not stored inline hold the context messages
+ * attached to the exception right after the header, such that the
+ * header of inline objects is three pointers.
+ */
+class exception_object
 {
-    // Construct the type information.
-    static constexpr type_info_entry info[] = {
-        std::size_t{}, // Number of source classes.
+public:
+    enum class operation
+    {
+        destroy,
+        relocate,
+        move_to_heap,
     };
-};
 
-template <typename Type, typename... Bases>
-constexpr auto type_id(define_exception_bases<Bases...>) noexcept
-{
-    return &type_information<Type, Bases...>::info;
-}
+    /**
+     * Performs the operation on the exception object:
+     * - `destroy` destroys the object and frees it using the allocator it
+     *   was created with.
+     * - `relocate` moves an object that is stored inline in an exit
+     *   condition to `storage`, and destroys this one.
+     * - `move_to_heap` moves an object that is stored inline in an exit
+     *   condition to a new object allocated with its allocator, and
+     *   destroys this one. If the allocation fails, returns null and
+     *   keeps this one.
+     * Returns the moved object, if any.
+     */
+    using manage_function = exception_object *(exception_object * object,
+                                               operation requested,
+                                               void * storage) noexcept;
 
-template <typename Type>
-constexpr auto type_id(define_exception_bases<>) noexcept
-{
-    return &type_information<Type>::info;
-}
+    /**
+     * Constructs the header of an object whose exception is at the given
+     * offset, which holds the context slot after the header if
+     * `has_context` is true.
+     */
+    exception_object(const void * type_id,
+                     std::size_t offset,
+                     bool has_context,
+                     manage_function * manage) noexcept :
+        m_type_id(type_id),
+        m_offset(std::uint16_t(offset)),
+        m_has_context(has_context),
+        m_manage(manage)
+    {
+    }
 
-template <typename Type>
-constexpr auto type_id() noexcept -> const void *
-{
-    using type = std::remove_cv_t<std::remove_reference_t<Type>>;
-    return detail::type_id<type>(define_exception_t<type>{});
-}
+    exception_object(const exception_object &) = delete;
+    exception_object & operator=(const exception_object &) = delete;
 
-inline void * dyn_cast(const void * base,
-                       void * most_derived_pointer,
-                       const void * most_derived)
-{
-    // If the most derived and the base are the same.
-    if (most_derived == base) {
-        return most_derived_pointer;
+    struct dynamic_object dynamic_object() noexcept
+    {
+        return {m_type_id, reinterpret_cast<std::byte *>(this) + m_offset};
     }
 
-    // Fetch the type info entries.
-    auto type_info_entries =
-        reinterpret_cast<const type_info_entry *>(most_derived);
+    /**
+     * Releases a reference to the exception object, destroys and frees
+     * it using the allocator it was created with if it was the last.
+     */
+    void destroy() noexcept
+    {
+        // Objects that are not shared skip the atomic decrement.
+        if (m_references.load(std::memory_order_acquire) == 1 ||
+            m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (m_has_context && context_slot()) [[unlikely]] {
+                detail::error_context_block::release(context_slot());
+            }
+            m_manage(this, operation::destroy, nullptr);
+        }
+    }
+
+    /**
+     * Attaches a context message to the exception, the message must
+     * outlive the exception object. The context of a shared object is
+     * common to all of its owners, hence messages are not attached to
+     * it once shared. Objects stored inline have no context, and must
+     * be moved out of line first.
+     */
+    void add_context(std::string_view message) noexcept
+    {
+        if (!m_has_context ||
+            m_references.load(std::memory_order_acquire) != 1)
+            [[unlikely]] {
+            return;
+        }
+        context_slot() =
+            detail::error_context_block::append(context_slot(), message);
+    }
 
-    // The number of base types.
-    auto number_of_base_types = type_info_entries->number;
+    /**
+     * Returns the context messages attached to the exception.
+     */
+    error_context context() const noexcept
+    {
+        return error_context{m_has_context ? context_slot() : nullptr};
+    }
 
-    // The bases type information.
-    auto bases = type_info_entries + 1;
+    /**
+     * Detaches the context messages from the exception so that they
+     * outlive it, unless the exception object is shared.
+     */
+    detail::error_context_block * release_context() noexcept
+    {
+        if (!m_has_context ||
+            m_references.load(std::memory_order_acquire) != 1) {
+            return nullptr;
+        }
+        return std::exchange(context_slot(), nullptr);
+    }
 
-    // The erased static cast function matching base.
-    auto erased_static_cast = bases + number_of_base_types;
+    /**
+     * Adds a reference to the exception object, which must not be stored
+     * inline in an exit condition. Returns this object.
+     */
+    exception_object * share() noexcept
+    {
+        m_references.fetch_add(1, std::memory_order_relaxed);
+        return this;
+    }
 
-    for (std::size_t index = 0; index < number_of_base_types; ++index) {
-        // Converting the most derived to the type whose id is
-        // bases[index].number and perform the conversion from this
-        // type.
-        auto result = dyn_cast(
-            base,
-            erased_static_cast[index].function(most_derived_pointer),
-            bases[index].pointer);
+    /**
+     * Moves an exception object that is stored inline in an exit
+     * condition to the given storage, and destroys this one.
+     * Returns the moved object.
+     */
+    exception_object * relocate(void * storage) noexcept
+    {
+        return m_manage(this, operation::relocate, storage);
+    }
 
-        // If the conversion succeeded, return the result.
-        if (result) {
-            return result;
-        }
+    /**
+     * Moves an exception object that is stored inline in an exit
+     * condition to a new object allocated with its allocator, and
+     * destroys this one. Returns the moved object, or null, keeping
+     * this one, if the allocation fails.
+     */
+    exception_object * move_to_heap() noexcept
+    {
+        return m_manage(this, operation::move_to_heap, nullptr);
     }
 
-    // No conversion was found.
-    return nullptr;
-}
+    static constexpr struct dynamic_object null_dynamic_object = {};
 
-template <typename Type>
-struct catch_type
-    : catch_type<decltype(&std::remove_cv_t<
-                          std::remove_reference_t<Type>>::operator())>
-{
-};
+private:
+    /**
+     * The context of an object that has a context slot, which directly
+     * follows the header, see `detail::exception_value`.
+     */
+    detail::error_context_block *& context_slot() noexcept
+    {
+        return *reinterpret_cast<detail::error_context_block **>(
+            reinterpret_cast<std::byte *>(this) + sizeof(exception_object));
+    }
 
-template <typename ReturnType, typename Argument>
-struct catch_type<ReturnType (*)(Argument)>
-{
-    using type = Argument;
+    detail::error_context_block * context_slot() const noexcept
+    {
+        return *reinterpret_cast<detail::error_context_block * const *>(
+            reinterpret_cast<const std::byte *>(this) +
+            sizeof(exception_object));
+    }
+
+    const void * m_type_id{};
+    std::uint16_t m_offset{};
+    bool m_has_context{};
+    std::atomic<std::uint32_t> m_references{1};
+    manage_function * m_manage{};
 };
 
-template <typename Type, typename ReturnType, typename Argument>
-struct catch_type<ReturnType (Type::*)(Argument)>
-{
-    using type = Argument;
-};
-
-template <typename Type, typename ReturnType, typename Argument>
-struct catch_type<ReturnType (Type::*)(Argument) const>
-{
-    using type = Argument;
-};
-
-template <typename ReturnType, typename Argument>
-struct catch_type<ReturnType (*)(Argument) noexcept>
+namespace detail
 {
-    using type = Argument;
-};
-
-template <typename Type, typename ReturnType, typename Argument>
-struct catch_type<ReturnType (Type::*)(Argument) noexcept>
+/**
+ * Makes the context of the exception that is being caught, if any, the
+ * current error context while the catch clause runs.
+ */
+class error_context_scope
 {
-    using type = Argument;
-};
+public:
+    explicit error_context_scope(const exception_object * exception) noexcept
+        :
+        m_previous(current())
+    {
+        current() = exception ? exception->context() : error_context{};
+    }
 
-template <typename Type, typename ReturnType, typename Argument>
-struct catch_type<ReturnType (Type::*)(Argument) const noexcept>
-{
-    using type = Argument;
-};
+    /**
+     * Makes the detached context current, and frees it at scope exit.
+     */
+    explicit error_context_scope(error_context_block * context) noexcept :
+        m_previous(current()), m_context(context)
+    {
+        current() = error_context{context};
+    }
 
-template <typename ReturnType>
-struct catch_type<ReturnType (*)()>
-{
-    using type = void;
-};
+    error_context_scope(const error_context_scope &) = delete;
+    error_context_scope & operator=(const error_context_scope &) = delete;
 
-template <typename Type, typename ReturnType>
-struct catch_type<ReturnType (Type::*)()>
-{
-    using type = void;
-};
+    ~error_context_scope()
+    {
+        current() = m_previous;
+        if (m_context) [[unlikely]] {
+            error_context_block::release(m_context);
+        }
+    }
 
-template <typename Type, typename ReturnType>
-struct catch_type<ReturnType (Type::*)() const>
-{
-    using type = void;
-};
+    static error_context & current() noexcept
+    {
+        static thread_local error_context context;
+        return context;
+    }
 
-template <typename ReturnType>
-struct catch_type<ReturnType (*)() noexcept>
-{
-    using type = void;
+private:
+    error_context m_previous;
+    error_context_block * m_context{};
 };
+} // namespace detail
 
-template <typename Type, typename ReturnType>
-struct catch_type<ReturnType (Type::*)() noexcept>
+/**
+ * Returns the context messages attached to the exception that is being
+ * caught, to be called within a catch clause of an exception.
+ */
+inline error_context current_error_context() noexcept
 {
-    using type = void;
-};
+    return detail::error_context_scope::current();
+}
 
-template <typename Type, typename ReturnType>
-struct catch_type<ReturnType (Type::*)() const noexcept>
+/**
+ * Define base classes for a particular exception.
+ */
+template <typename... Bases>
+struct define_exception_bases
 {
-    using type = void;
 };
 
+/**
+ * Define an exception to be supported by the framework.
+ * ```cpp
+ * template<>
+ * struct zpp::define_exception<my_exception>
+ * {
+ *     using type = zpp::define_exception_bases<exception_base_1,
+ * exception_base_2>;
+ * };
+ * ```
+ */
 template <typename Type>
-using catch_type_t = typename catch_type<Type>::type;
-
-template <typename Type>
-struct catch_value_type
-{
-    using type =
-        std::remove_cv_t<std::remove_reference_t<catch_type_t<Type>>>;
-};
+struct define_exception;
 
 template <typename Type>
-using catch_value_type_t = typename catch_value_type<Type>::type;
-
-} // namespace detail
+using define_exception_t = typename define_exception<Type>::type;
 
 /**
- * The exit condition of the coroutine - A value, or error/exception.
+ * Recycles coroutine frames using thread local free lists that are
+ * bucketed by frame size class. Opt-in by using it as the allocator:
+ * ```cpp
+ * zpp::throwing<int, zpp::frame_recycler> foo();
+ * ```
+ * Only coroutine frames are recycled, exception objects are allocated
+ * the same way as with the default allocator.
  */
-template <typename Type, typename Allocator>
-struct exit_condition
+class frame_recycler
 {
-    using exception_type = exception_object *;
-    using error_type = class error;
-    using value_type = std::conditional_t<
-        std::is_void_v<Type>,
-        std::nullptr_t,
-        std::conditional_t<
-            std::is_reference_v<Type>,
-            std::add_pointer_t<std::remove_reference_t<Type>>,
-            Type>>;
+public:
+    /**
+     * The size class granularity, frame sizes are rounded up to it.
+     */
+    static constexpr std::size_t size_class_granularity = 64;
 
-    constexpr exit_condition() noexcept :
-        m_error_domain(std::addressof(err_domain<rethrow_error>))
-    {
-    }
+    /**
+     * The number of size classes, larger frames are not recycled.
+     */
+    static constexpr std::size_t size_classes = 16;
 
-    template <typename..., typename Dependent = Type>
-    constexpr explicit exit_condition(void_t) requires std::is_void_v<Dependent>
-        : m_error_domain(nullptr)
-    {
-    }
+    /**
+     * The maximum number of cached frames per size class.
+     */
+    static constexpr std::size_t max_cached_frames = 64;
 
-    constexpr explicit exit_condition(auto && value) :
-        m_error_domain(nullptr),
-        m_return_value(std::forward<decltype(value)>(value))
+    /**
+     * Allocation statistics of the current thread.
+     */
+    struct statistics
     {
-    }
+        std::size_t allocations{};
+        std::size_t recycled{};
+        std::size_t deallocations{};
+    };
 
-    constexpr exit_condition(exit_condition && other) noexcept
+    /**
+     * Allocates a frame of the given size, reusing a cached frame of the
+     * same size class if there is one.
+     */
+    static void * allocate(std::size_t size)
     {
-        if (other.is_value()) {
-            if constexpr (!std::is_void_v<Type>) {
-                if constexpr (!std::is_reference_v<Type>) {
-                    ::new (std::addressof(m_return_value))
-                        Type(std::move(other.m_return_value));
-                } else {
-                    m_return_value = other.m_return_value;
-                }
-            }
-        } else {
-            m_error_domain = other.m_error_domain;
-            std::memcpy(&m_error, &other.m_error, sizeof(m_error));
+        auto & cache = local_cache();
+        ++cache.stats.allocations;
+
+        auto index = size_class(size);
+        if (index >= size_classes) {
+            return ::operator new(size);
         }
-    }
 
-    constexpr ~exit_condition()
-    {
-        if constexpr (!std::is_void_v<Type> &&
-                      !std::is_trivially_destructible_v<Type>) {
-            if (is_value()) {
-                m_return_value.~Type();
-            }
+        auto & list = cache.lists[index];
+        if (auto block = list.head) {
+            list.head = block->next;
+            --list.count;
+            ++cache.stats.recycled;
+            return block;
         }
-    }
 
-    constexpr bool is_exception() const noexcept
-    {
-        return m_error_domain ==
-               std::addressof(err_domain<throwing_exception>);
+        return ::operator new((index + 1) * size_class_granularity);
     }
 
-    constexpr bool is_value() const noexcept
+    /**
+     * Returns a frame to the cache of the current thread, or frees it if
+     * the cache of its size class is full.
+     */
+    static void deallocate(void * pointer, std::size_t size) noexcept
     {
-        return !m_error_domain;
-    }
+        auto & cache = local_cache();
+        ++cache.stats.deallocations;
 
-    constexpr bool success() const noexcept
-    {
-        return !m_error_domain;
+        auto index = size_class(size);
+        if (index >= size_classes ||
+            cache.lists[index].count == max_cached_frames) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto & list = cache.lists[index];
+        list.head = ::new (pointer) free_block{list.head};
+        ++list.count;
     }
 
-    constexpr bool failure() const noexcept
+    /**
+     * Returns the allocation statistics of the current thread.
+     */
+    static struct statistics statistics() noexcept
     {
-        return m_error_domain;
+        return local_cache().stats;
     }
 
-    constexpr bool is_error() const noexcept
+    /**
+     * Frees all frames cached by the current thread.
+     */
+    static void release() noexcept
     {
-        return !is_value() && !is_exception();
+        local_cache().release();
     }
 
-    constexpr auto is_rethrow() const noexcept
+private:
+    struct free_block
     {
-        return m_error_domain == std::addressof(err_domain<rethrow_error>);
-    }
+        free_block * next{};
+    };
 
-    constexpr explicit operator bool() const noexcept
+    struct free_list
     {
-        return success();
-    }
+        free_block * head{};
+        std::size_t count{};
+    };
 
-    constexpr decltype(auto) value() && noexcept
+    struct cache
     {
-        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
-            return std::forward<Type>(m_return_value);
-        } else {
-            return std::forward<Type>(*m_return_value);
+        ~cache()
+        {
+            release();
         }
-    }
 
-    constexpr decltype(auto) value() & noexcept
-    {
-        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
-            return (m_return_value);
-        } else {
-            return (*m_return_value);
+        void release() noexcept
+        {
+            for (auto & list : lists) {
+                while (auto block = list.head) {
+                    list.head = block->next;
+                    ::operator delete(block);
+                }
+                list.count = 0;
+            }
         }
-    }
 
-    constexpr auto & exception() noexcept
+        free_list lists[size_classes]{};
+        struct statistics stats{};
+    };
+
+    static constexpr std::size_t size_class(std::size_t size) noexcept
     {
-        return *m_error.exception;
+        return (size + size_class_granularity - 1) / size_class_granularity -
+               1;
     }
 
-    constexpr auto error() const noexcept
+    static cache & local_cache() noexcept
     {
-        return error_type{m_error.code, *m_error_domain};
+        static thread_local cache cache;
+        return cache;
     }
+};
 
+/**
+ * A thread local bump arena that is installed for the duration of a
+ * scope, see `zpp::arena_try_catch`. While installed, all allocations
+ * made with `zpp::scoped_arena_allocator` on the current thread are
+ * carved from the arena. Freeing them does nothing, and when the
+ * outermost scope exits the arena is reset in one shot instead.
+ * Nothing allocated from the arena may outlive the outermost scope,
+ * which is checked when `ZPP_THROWING_CHECK_ARENAS` is defined.
+ */
+class scoped_arena
+{
+public:
     /**
-     * Exits with a value.
-     * Must call exit functions exactly once.
+     * The default size of the chunks carved by the arena.
      */
-    template <typename..., typename Dependent = Type>
-    constexpr void
-    exit_with_value(auto && value) requires(!std::is_void_v<Dependent>)
-    {
-        if constexpr (!std::is_void_v<Type>) {
-            if constexpr (!std::is_reference_v<Type>) {
-                ::new (std::addressof(m_return_value))
-                    Type(std::forward<decltype(value)>(value));
-            } else {
-                m_return_value = std::addressof(value);
-            }
-        }
-        m_error_domain = nullptr;
-    }
+    static constexpr std::size_t chunk_size = 16 * 1024;
 
-    template <typename..., typename Dependent = Type>
-    constexpr void exit_with_value() requires std::is_void_v<Dependent>
+    /**
+     * Allocation statistics of the current thread.
+     */
+    struct statistics
     {
-        m_error_domain = nullptr;
-    }
+        std::size_t arena_allocations{};
+        std::size_t heap_allocations{};
+        std::size_t resets{};
+    };
 
     /**
-     * Exits with exception.
-     * Must call exit functions exactly once.
+     * Installs the arena of the current thread if not installed yet.
      */
-    template <typename Exception>
-    auto exit_with_exception(Exception && exception) noexcept
+    scoped_arena()
     {
-        using type = std::remove_cv_t<std::remove_reference_t<Exception>>;
-
-        // Define the exception object that will be type erased.
-        struct exception_holder : public exception_object
-        {
-            exception_holder(Exception && exception) :
-                m_exception(std::forward<Exception>(exception))
-            {
-            }
+        auto & state = local_state();
+        if (state.active) {
+            ++state.active->depth;
+            return;
+        }
 
-            auto dynamic_object() noexcept
-                -> struct dynamic_object override
-            {
-                // Return the type id of the exception object and its
-                // address.
-                return {detail::type_id<type>(),
-                        std::addressof(m_exception)};
-            }
+        state.active = state.idle ? state.idle : new arena{};
+        state.idle = nullptr;
+        state.active->depth = 1;
+    }
 
-            ~exception_holder() override = default;
+    scoped_arena(const scoped_arena &) = delete;
+    scoped_arena & operator=(const scoped_arena &) = delete;
 
-            type m_exception;
+    /**
+     * Uninstalls and resets the arena if this is the outermost scope.
+     */
+    ~scoped_arena()
+    {
+        auto & state = local_state();
+        auto active = state.active;
+        if (--active->depth) {
+            return;
+        }
+
+#ifdef ZPP_THROWING_CHECK_ARENAS
+        if (active->live) {
+            std::terminate();
+        }
+#endif
+
+        state.active = nullptr;
+        active->reset();
+        ++state.stats.resets;
+        state.idle = active;
+    }
+
+    /**
+     * Allocates from the installed arena, or from the heap if there is
+     * no arena installed.
+     */
+    static void * allocate(std::size_t size)
+    {
+        auto & state = local_state();
+        auto active = state.active;
+        if (!active) {
+            ++state.stats.heap_allocations;
+            auto allocated = static_cast<header *>(
+                ::operator new(sizeof(header) + size));
+            allocated->owner = nullptr;
+            return allocated + 1;
+        }
+
+        ++state.stats.arena_allocations;
+        auto allocated = static_cast<header *>(
+            active->allocate(sizeof(header) + round_up(size)));
+        allocated->owner = active;
+#ifdef ZPP_THROWING_CHECK_ARENAS
+        ++active->live;
+#endif
+        return allocated + 1;
+    }
+
+    /**
+     * Frees memory allocated with `allocate`, which does nothing for
+     * memory of the arena.
+     */
+    static void deallocate(void * pointer) noexcept
+    {
+        auto allocated = static_cast<header *>(pointer) - 1;
+        auto owner = allocated->owner;
+        if (!owner) {
+            ::operator delete(allocated);
+            return;
+        }
+
+#ifdef ZPP_THROWING_CHECK_ARENAS
+        --owner->live;
+#endif
+    }
+
+    /**
+     * Returns the allocation statistics of the current thread.
+     */
+    static struct statistics statistics() noexcept
+    {
+        return local_state().stats;
+    }
+
+private:
+    struct arena;
+
+    struct alignas(std::max_align_t) header
+    {
+        arena * owner;
+    };
+
+    static constexpr std::size_t round_up(std::size_t size) noexcept
+    {
+        return (size + alignof(header) - 1) & ~(alignof(header) - 1);
+    }
+
+    struct arena
+    {
+        struct alignas(std::max_align_t) chunk
+        {
+            chunk * next;
+            std::byte * end;
         };
 
-        m_error_domain = std::addressof(err_domain<throwing_exception>);
-        m_error.exception =
-            make_exception_object<exception_holder, Allocator>(
-                std::forward<Exception>(exception));
+        void * allocate(std::size_t size)
+        {
+            if (std::size_t(end - position) < size) {
+                auto capacity = size < chunk_size ? chunk_size : size;
+                auto allocated = static_cast<chunk *>(
+                    ::operator new(sizeof(chunk) + capacity));
+                allocated->end =
+                    reinterpret_cast<std::byte *>(allocated + 1) +
+                    capacity;
+
+                // Keep the first chunk first, it is the one kept on reset.
+                if (chunks) {
+                    allocated->next = chunks->next;
+                    chunks->next = allocated;
+                } else {
+                    allocated->next = nullptr;
+                    chunks = allocated;
+                }
+                position = reinterpret_cast<std::byte *>(allocated + 1);
+                end = allocated->end;
+            }
 
-        if constexpr (std::is_void_v<Allocator>) {
-            // Nothing to be done.
-        } else if constexpr (noexcept(std::declval<Allocator>().allocate(
-                                 std::size_t{}))) {
-            if (!m_error.exception) {
-                exit_with_error(std::errc::not_enough_memory);
+            auto allocated = position;
+            position += size;
+            return allocated;
+        }
+
+        void reset() noexcept
+        {
+            if (!chunks) {
+                return;
+            }
+
+            // Free all but the first chunk.
+            while (auto next = chunks->next) {
+                chunks->next = next->next;
+                ::operator delete(next);
+            }
+            position = reinterpret_cast<std::byte *>(chunks + 1);
+            end = chunks->end;
+        }
+
+        void release() noexcept
+        {
+            while (auto current = chunks) {
+                chunks = current->next;
+                ::operator delete(current);
+            }
+            position = end = nullptr;
+        }
+
+        chunk * chunks{};
+        std::byte * position{};
+        std::byte * end{};
+        std::size_t live{};
+        std::size_t depth{};
+    };
+
+    struct state
+    {
+        ~state()
+        {
+            if (idle) {
+                idle->release();
+                delete idle;
             }
         }
+
+        arena * active{};
+        arena * idle{};
+        struct statistics stats{};
+    };
+
+    static state & local_state() noexcept
+    {
+        static thread_local state state;
+        return state;
+    }
+};
+
+/**
+ * An allocator that allocates from the `zpp::scoped_arena` installed on
+ * the current thread, or from the heap if there is none.
+ * ```cpp
+ * zpp::throwing<int, zpp::scoped_arena_allocator> foo();
+ * ```
+ */
+struct scoped_arena_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t size)
+    {
+        return static_cast<std::byte *>(scoped_arena::allocate(size));
     }
 
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        scoped_arena::deallocate(pointer);
+    }
+
+    friend bool operator==(const scoped_arena_allocator &,
+                           const scoped_arena_allocator &) = default;
+};
+
+/**
+ * A fixed capacity pool of `BlockCount` blocks of `BlockSize` bytes in
+ * static storage, for builds without a heap. Allocation does not throw
+ * and returns null when the pool is exhausted or the size is larger than
+ * a block, so a coroutine that fails to allocate its frame returns the
+ * `std::errc::not_enough_memory` error. Exceptions that fail to allocate
+ * are held by `zpp::emergency_exception_buffer`.
+ * Each `Tag` has a distinct pool. The pool is not thread safe, use
+ * a distinct `Tag` per thread.
+ * ```cpp
+ * using pool = zpp::static_pool_allocator<256, 64>;
+ * zpp::throwing<int, pool> foo();
+ * ```
+ */
+template <std::size_t BlockSize,
+          std::size_t BlockCount,
+          typename Tag = void>
+class static_pool_allocator
+{
+public:
+    using value_type = std::byte;
+
     /**
-     * This must not hold a value or an exception.
-     * Must call exit functions exactly once.
+     * The size of each block, rounded up to keep blocks max aligned.
      */
-    constexpr void exit_rethrow() noexcept
+    static constexpr std::size_t block_size =
+        (BlockSize + alignof(std::max_align_t) - 1) &
+        ~(alignof(std::max_align_t) - 1);
+
+    /**
+     * The number of blocks in the pool.
+     */
+    static constexpr std::size_t block_count = BlockCount;
+
+    std::byte * allocate(std::size_t size) noexcept
     {
-        m_error_domain = std::addressof(err_domain<rethrow_error>);
+        if (size > block_size) [[unlikely]] {
+            return nullptr;
+        }
+
+        std::byte * allocated = nullptr;
+        if (auto block = s_pool.free_list) {
+            s_pool.free_list = block->next;
+            allocated = reinterpret_cast<std::byte *>(block);
+        } else if (s_pool.untouched != block_count) {
+            allocated = s_pool.storage + block_size * s_pool.untouched++;
+        } else [[unlikely]] {
+            return nullptr;
+        }
+
+        if (++s_pool.in_use > s_pool.high_water_mark) {
+            s_pool.high_water_mark = s_pool.in_use;
+        }
+        return allocated;
+    }
+
+    void deallocate(std::byte * pointer, std::size_t) noexcept
+    {
+        s_pool.free_list = ::new (pointer) free_block{s_pool.free_list};
+        --s_pool.in_use;
     }
 
     /**
-     * Exits with an error value.
-     * Must call exit functions exactly once.
+     * Returns the number of blocks currently allocated.
      */
-    constexpr void exit_with_error(const error_type & error) noexcept
+    static std::size_t in_use() noexcept
     {
-        m_error_domain = std::addressof(error.domain());
-        m_error.code = error.code();
+        return s_pool.in_use;
     }
 
     /**
-     * Propagates an exception/error.
-     * Must call exit functions exactly once, `other` must have an
-     * error or an exception.
+     * Returns the maximum number of blocks that were allocated at the
+     * same time, use it to size the pool.
      */
-    template <typename OtherType>
-    constexpr void
-    exit_propagate(exit_condition<OtherType, Allocator> & other) noexcept
+    static std::size_t high_water_mark() noexcept
     {
-        m_error_domain = other.m_error_domain;
-        std::memcpy(&m_error, &other.m_error, sizeof(m_error));
+        return s_pool.high_water_mark;
     }
 
-    union error_storage
+    friend bool operator==(const static_pool_allocator &,
+                           const static_pool_allocator &) = default;
+
+private:
+    struct free_block
     {
-        int code;
-        exception_type exception;
+        free_block * next{};
     };
 
-    const error_domain * m_error_domain{};
-    union
+    struct pool
     {
-        error_storage m_error;
-        value_type m_return_value;
+        alignas(std::max_align_t) std::byte
+            storage[block_size * BlockCount];
+        free_block * free_list;
+        std::size_t untouched;
+        std::size_t in_use;
+        std::size_t high_water_mark;
     };
+
+    static inline pool s_pool{};
 };
 
 /**
- * Use as the return type of the function, throw exceptions
- * by using `co_yield` / `co_return`. Using `co_yield` is clearer
- * but in some cases may generate less code than `co_return`.
- * If you want to throw exceptions using `co_return` in void returning
- * functions, use `zpp::throwing<zpp::void_t>` instead, and `co_return
- * zpp::void_v` to exit normally). Call throwing functions by `co_await`,
- * and return values using `co_return`. Use the `zpp::try_catch` function
- * to execute a function object and then to catch exceptions thrown from
- * it.
+ * A pool allocator whose blocks may be freed by any thread, such as
+ * when throwing results and the exceptions they hold are handed between
+ * threads:
+ * ```cpp
+ * zpp::throwing<int, zpp::concurrent_pool_allocator> foo();
+ * ```
+ * Each thread allocates from its own pages of fixed size blocks without
+ * synchronization. Blocks freed by other threads are pushed to a lock
+ * free queue of their page, which the owning thread reclaims in one
+ * batch once the local free blocks of the page run out.
+ * Allocations larger than `max_block_size` use the global operator new.
+ * Pages of an exiting thread are freed once all their blocks are freed.
  */
-template <typename Type, typename Allocator = void>
-class [[nodiscard]] throwing
+class concurrent_pool_allocator
 {
 public:
-    template <typename, typename>
-    friend class throwing;
+    using value_type = std::byte;
 
-    struct zpp_throwing_tag
+    /**
+     * The size class granularity, block sizes are rounded up to it.
+     */
+    static constexpr std::size_t size_class_granularity = 64;
+
+    /**
+     * The number of size classes.
+     */
+    static constexpr std::size_t size_classes = 16;
+
+    /**
+     * The largest block size allocated from the pool.
+     */
+    static constexpr std::size_t max_block_size =
+        size_class_granularity * size_classes;
+
+    /**
+     * The size and alignment of the pages that blocks are carved from.
+     */
+    static constexpr std::size_t page_size = 64 * 1024;
+
+    /**
+     * Allocation statistics of the current thread.
+     */
+    struct statistics
     {
+        std::size_t allocations{};
+        std::size_t remote_frees{};
+        std::size_t reclaims{};
     };
 
+    std::byte * allocate(std::size_t size)
+    {
+        auto index = size_class(size);
+        if (index >= size_classes) [[unlikely]] {
+            return static_cast<std::byte *>(::operator new(size));
+        }
+
+        auto & heap = local_heap();
+        ++heap.stats.allocations;
+        if (auto page = heap.pages[index]) [[likely]] {
+            if (auto block = page->pop()) [[likely]] {
+                return block;
+            }
+        }
+        return heap.allocate_slow(index);
+    }
+
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        if (size_class(size) >= size_classes) [[unlikely]] {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto & page = *reinterpret_cast<struct page *>(
+            reinterpret_cast<std::uintptr_t>(pointer) & ~(page_size - 1));
+        auto & heap = local_heap();
+        if (page.owner.load(std::memory_order_relaxed) == &heap)
+            [[likely]] {
+            page.local_free = ::new (pointer) free_block{page.local_free};
+            return;
+        }
+
+        ++heap.stats.remote_frees;
+        page.remote_free(pointer);
+    }
+
     /**
-     * The promise type to be extended with return value / return void
-     * functionality.
+     * Returns the allocation statistics of the current thread.
      */
-    class basic_promise_type
+    static struct statistics statistics() noexcept
     {
-    public:
-        template <typename, typename>
-        friend class throwing;
+        return local_heap().stats;
+    }
 
-        struct suspend_destroy
-        {
-            constexpr bool await_ready() noexcept { return false; }
-            void await_suspend(auto handle) noexcept { handle.destroy(); }
-            [[noreturn]] void await_resume() noexcept { while (true); }
-        };
+    friend bool operator==(const concurrent_pool_allocator &,
+                           const concurrent_pool_allocator &) = default;
 
-        auto get_return_object()
-        {
-            return throwing{static_cast<promise_type &>(*this)};
-        }
+private:
+    struct heap;
 
-        auto initial_suspend() noexcept
+    struct free_block
+    {
+        free_block * next{};
+    };
+
+    /**
+     * A page of blocks of a single size class, the header is placed at
+     * the beginning of the page so that blocks find it by alignment.
+     */
+    struct page
+    {
+        /**
+         * Marks the remote free queue of a page whose owner exited.
+         */
+        static constexpr std::uintptr_t abandoned = 1;
+
+        static constexpr std::size_t header_size =
+            (sizeof(std::uintptr_t) * 8 + size_class_granularity - 1) &
+            ~(size_class_granularity - 1);
+
+        static page * create(heap * owner, std::size_t block_size)
         {
-            return suspend_never{};
+            auto allocated = static_cast<std::byte *>(
+                ::operator new(page_size, std::align_val_t{page_size}));
+            auto created = ::new (allocated) page{};
+            created->owner.store(owner, std::memory_order_relaxed);
+            created->untouched = allocated + header_size;
+            created->block_size = block_size;
+            return created;
         }
 
-        auto final_suspend() noexcept
+        static void destroy(page * destroyed) noexcept
         {
-            return suspend_never{};
+            destroyed->~page();
+            ::operator delete(destroyed, std::align_val_t{page_size});
         }
 
-        void unhandled_exception()
+        std::byte * pop() noexcept
         {
-            std::terminate();
+            if (auto block = local_free) [[likely]] {
+                local_free = block->next;
+                return reinterpret_cast<std::byte *>(block);
+            }
+            return nullptr;
         }
 
         /**
-         * Throw and destroy calling coroutine.
+         * Carves a block from the untouched part of the page.
          */
-        template <typename Value>
-        auto yield_value(Value && value)
+        std::byte * extend() noexcept
         {
-            throw_it(std::forward<Value>(value));
-            return suspend_destroy{};
+            auto end = reinterpret_cast<std::byte *>(this) + page_size;
+            if (std::size_t(end - untouched) >= block_size) {
+                auto block = untouched;
+                untouched += block_size;
+                return block;
+            }
+            return nullptr;
         }
 
         /**
-         * Throw an exception.
+         * Moves the remotely freed blocks to the local free list in one
+         * batch, returns false if there are none.
          */
-        template <typename Value>
-        void throw_it(Value && value) requires requires
+        bool reclaim() noexcept
         {
-            define_exception<
-                std::remove_cv_t<std::remove_reference_t<Value>>>();
+            if (!thread_free.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            local_free = reinterpret_cast<free_block *>(
+                thread_free.exchange(0, std::memory_order_acquire));
+            return true;
         }
+
+        void remote_free(std::byte * pointer) noexcept
         {
-            m_return_object->m_condition.exit_with_exception(
-                std::forward<Value>(value));
+            auto head = thread_free.load(std::memory_order_relaxed);
+            do {
+                if (head & abandoned) {
+                    if (abandoned_live.fetch_sub(
+                            1, std::memory_order_acq_rel) == 1) {
+                        destroy(this);
+                    }
+                    return;
+                }
+                ::new (pointer)
+                    free_block{reinterpret_cast<free_block *>(head)};
+            } while (!thread_free.compare_exchange_weak(
+                head,
+                reinterpret_cast<std::uintptr_t>(pointer),
+                std::memory_order_release,
+                std::memory_order_relaxed));
         }
 
         /**
-         * Rethrow from existing.
+         * Called by the owner when exiting, the page is destroyed by
+         * whoever frees its last block.
          */
-        template <typename ExitCondition>
-        void throw_it(
-            std::tuple<const rethrow_t &, ExitCondition &> error_condition)
+        void abandon() noexcept
         {
-            m_return_object->m_condition.exit_propagate(
-                std::get<1>(error_condition));
+            owner.store(nullptr, std::memory_order_relaxed);
+            auto remote =
+                reinterpret_cast<free_block *>(thread_free.exchange(
+                    abandoned, std::memory_order_acq_rel));
+
+            auto begin = reinterpret_cast<std::byte *>(this) + header_size;
+            auto outstanding =
+                std::ptrdiff_t((untouched - begin) / block_size);
+            for (auto block = local_free; block; block = block->next) {
+                --outstanding;
+            }
+            for (auto block = remote; block; block = block->next) {
+                --outstanding;
+            }
+
+            if (abandoned_live.fetch_add(outstanding,
+                                         std::memory_order_acq_rel) +
+                    outstanding ==
+                0) {
+                destroy(this);
+            }
         }
 
-        /**
-         * Rethrow the current set exception.
-         */
-        void throw_it(rethrow_t)
+        std::atomic<heap *> owner{};
+        page * next{};
+        free_block * local_free{};
+        std::byte * untouched{};
+        std::size_t block_size{};
+        std::atomic<std::uintptr_t> thread_free{};
+        std::atomic<std::ptrdiff_t> abandoned_live{};
+    };
+
+    static_assert(sizeof(page) <= page::header_size);
+
+    struct heap
+    {
+        ~heap()
         {
-            m_return_object->m_condition.exit_rethrow();
+            for (auto list : pages) {
+                while (auto page = list) {
+                    list = page->next;
+                    page->abandon();
+                }
+            }
         }
 
         /**
-         * Throw an error.
+         * Finds a page of the size class with remotely freed, free or
+         * untouched blocks, in this order, and makes it the current page,
+         * or creates one.
          */
-        void throw_it(const error & error)
+        std::byte * allocate_slow(std::size_t index)
         {
-            m_return_object->m_condition.exit_with_error(error);
+            page * previous = nullptr;
+            for (auto page = pages[index]; page;
+                 previous = page, page = page->next) {
+                if (!page->local_free && page->reclaim()) {
+                    ++stats.reclaims;
+                }
+                auto block = page->pop();
+                if (!block) {
+                    block = page->extend();
+                }
+                if (!block) {
+                    continue;
+                }
+                if (previous) {
+                    previous->next = page->next;
+                    page->next = pages[index];
+                    pages[index] = page;
+                }
+                return block;
+            }
+
+            auto created =
+                page::create(this, (index + 1) * size_class_granularity);
+            created->next = pages[index];
+            pages[index] = created;
+            return created->extend();
         }
 
-    protected:
-        ~basic_promise_type() = default;
+        page * pages[size_classes]{};
+        struct statistics stats{};
+    };
+
+    static constexpr std::size_t size_class(std::size_t size) noexcept
+    {
+        return (size + size_class_granularity - 1) /
+                   size_class_granularity -
+               1;
+    }
+
+    static heap & local_heap() noexcept
+    {
+        static thread_local heap heap;
+        return heap;
+    }
+};
+
+namespace detail
+{
+/**
+ * Placeholder allocator of objects allocated with the global
+ * operator new.
+ */
+struct global_heap
+{
+};
+
+/**
+ * Allocates bytes with the allocator, aligned for any object.
+ */
+template <typename Allocator>
+std::byte * allocate_bytes(Allocator & allocator, std::size_t size)
+{
+    return std::allocator_traits<Allocator>::allocate(allocator, size);
+}
+
+/**
+ * Deallocates bytes allocated by `allocate_bytes`.
+ */
+template <typename Allocator>
+void deallocate_bytes(Allocator & allocator,
+                      std::byte * pointer,
+                      std::size_t size) noexcept
+{
+    std::allocator_traits<Allocator>::deallocate(allocator, pointer, size);
+}
+
+#ifdef __cpp_lib_memory_resource
+// A polymorphic allocator of bytes requests an alignment of one, hence
+// request the alignment from the memory resource explicitly.
+inline std::byte *
+allocate_bytes(std::pmr::polymorphic_allocator<std::byte> & allocator,
+               std::size_t size)
+{
+    return static_cast<std::byte *>(
+        allocator.resource()->allocate(size, alignof(std::max_align_t)));
+}
+
+inline void
+deallocate_bytes(std::pmr::polymorphic_allocator<std::byte> & allocator,
+                 std::byte * pointer,
+                 std::size_t size) noexcept
+{
+    allocator.resource()->deallocate(
+        pointer, size, alignof(std::max_align_t));
+}
+#endif
+
+} // namespace detail
+
+/**
+ * Caller provided storage for the frame of a coroutine that uses
+ * `zpp::inline_frame_allocator`. The storage may be reused once the
+ * coroutine completes.
+ */
+template <std::size_t Size>
+class inline_frame
+{
+public:
+    template <typename>
+    friend class inline_frame_allocator;
+
+    inline_frame() = default;
+    inline_frame(const inline_frame &) = delete;
+    inline_frame & operator=(const inline_frame &) = delete;
+
+    /**
+     * Returns true if a coroutine frame currently lives in the storage.
+     */
+    bool in_use() const noexcept
+    {
+        return m_in_use;
+    }
+
+private:
+    alignas(std::max_align_t) std::byte m_buffer[Size];
+    bool m_in_use{};
+};
+
+/**
+ * An allocator that places the coroutine frame in caller provided
+ * `zpp::inline_frame` storage if it fits, and otherwise falls back to
+ * `Allocator`. Pass the storage with leading `std::allocator_arg_t`
+ * parameters:
+ * ```cpp
+ * zpp::throwing<int, zpp::inline_frame_allocator<>>
+ * integer_divide(std::allocator_arg_t, zpp::inline_frame_allocator<>,
+ *                int x, int y);
+ *
+ * zpp::inline_frame<256> frame;
+ * co_await integer_divide(std::allocator_arg, frame, 4, 2);
+ * ```
+ * Only coroutine frames use the storage, exceptions are allocated the
+ * same way as with `Allocator`.
+ */
+template <typename Allocator = void>
+class inline_frame_allocator
+{
+public:
+    using value_type = std::byte;
+    using fallback_type = std::conditional_t<std::is_void_v<Allocator>,
+                                             detail::global_heap,
+                                             Allocator>;
+
+    /**
+     * Constructs from the frame storage and the fallback allocator.
+     */
+    template <std::size_t Size>
+    inline_frame_allocator(inline_frame<Size> & frame,
+                           const fallback_type & allocator = {}) :
+        m_buffer(frame.m_buffer),
+        m_size(Size),
+        m_in_use(std::addressof(frame.m_in_use)),
+        m_allocator(allocator)
+    {
+    }
+
+    std::byte * allocate(std::size_t size) noexcept(
+        noexcept(std::declval<std::conditional_t<std::is_void_v<Allocator>,
+                                                 std::allocator<std::byte>,
+                                                 Allocator> &>()
+                     .allocate(size)))
+    {
+        if (!*m_in_use && size <= m_size) [[likely]] {
+            *m_in_use = true;
+            return m_buffer;
+        }
+
+        if constexpr (std::is_void_v<Allocator>) {
+            return static_cast<std::byte *>(::operator new(size));
+        } else {
+            return detail::allocate_bytes(m_allocator, size);
+        }
+    }
+
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        if (pointer == m_buffer) [[likely]] {
+            *m_in_use = false;
+            return;
+        }
+
+        if constexpr (std::is_void_v<Allocator>) {
+            ::operator delete(pointer);
+        } else {
+            detail::deallocate_bytes(m_allocator, pointer, size);
+        }
+    }
+
+    /**
+     * Converts to the fallback allocator, which is used for exceptions.
+     */
+    operator const fallback_type &() const noexcept
+    {
+        return m_allocator;
+    }
+
+private:
+    std::byte * m_buffer{};
+    std::size_t m_size{};
+    bool * m_in_use{};
+    [[no_unique_address]] fallback_type m_allocator;
+};
+
+/**
+ * Profiles the allocation of coroutine frames by call site and frame
+ * size. Define `ZPP_THROWING_PROFILE_FRAMES` consistently in all
+ * translation units to record every frame allocation, otherwise nothing
+ * is recorded and no profiling code is compiled.
+ * The call site is the return address of the frame allocation function,
+ * which is within the coroutine whose frame is allocated, or within its
+ * caller if the coroutine is inlined into it. Frames are allocated with
+ * an additional `header_size` bytes while profiling.
+ * Each thread records into its own fixed size table without locks, and
+ * `dump()` reports the sites of all threads:
+ * ```cpp
+ * zpp::frame_profiler::dump([](const auto & site) {
+ *     std::printf("%p %zu: %zu allocations, %zu bytes, %zu live\n",
+ *                 site.address, site.frame_size, site.allocations,
+ *                 site.bytes, site.live);
+ * });
+ * ```
+ */
+class frame_profiler
+{
+public:
+    /**
+     * The size of the header that is placed before each profiled frame.
+     */
+    static constexpr std::size_t header_size =
+        __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    /**
+     * The number of distinct sites recorded per thread, further sites
+     * are accounted for in a single site with a null address.
+     */
+    static constexpr std::size_t table_size = 1024;
+
+    /**
+     * The statistics of a call site, summed over all threads.
+     */
+    struct call_site
+    {
+        const void * address{};
+        std::size_t frame_size{};
+        std::size_t allocations{};
+        std::size_t bytes{};
+        std::size_t live{};
+    };
+
+    /**
+     * Records the allocation of a frame of the given size from the given
+     * call site, where `allocated` points to `header_size + size` bytes.
+     * Returns the frame.
+     */
+    static void * allocated(void * allocated,
+                            std::size_t size,
+                            const void * address) noexcept
+    {
+        auto & slot = local_table().find(address, size);
+        slot.allocations.store(
+            slot.allocations.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+        slot.bytes.store(slot.bytes.load(std::memory_order_relaxed) + size,
+                         std::memory_order_relaxed);
+        ::new (allocated) entry *(&slot);
+        return static_cast<std::byte *>(allocated) + header_size;
+    }
+
+    /**
+     * Records the deallocation of a frame returned from `allocated()`,
+     * possibly on another thread. Returns the allocated pointer.
+     */
+    static void * deallocated(void * frame) noexcept
+    {
+        auto allocated = static_cast<std::byte *>(frame) - header_size;
+        (*std::launder(reinterpret_cast<entry **>(allocated)))
+            ->deallocations.fetch_add(1, std::memory_order_relaxed);
+        return allocated;
+    }
+
+    /**
+     * Calls `function` with each recorded `call_site`.
+     */
+    template <typename Function>
+    static void dump(Function && function)
+    {
+        auto head = tables().load(std::memory_order_acquire);
+        for (auto current = head; current; current = current->next) {
+            for (auto & entry : current->entries) {
+                auto address =
+                    entry.address.load(std::memory_order_acquire);
+                auto frame_size =
+                    entry.frame_size.load(std::memory_order_relaxed);
+                if (!address ||
+                    contains(head, current, address, frame_size)) {
+                    continue;
+                }
+
+                call_site site{address, frame_size};
+                for (auto table = current; table; table = table->next) {
+                    if (auto other = table->lookup(address, frame_size)) {
+                        other->add_to(site);
+                    }
+                }
+                function(site);
+            }
+        }
+
+        call_site site{};
+        for (auto table = head; table; table = table->next) {
+            table->overflow.add_to(site);
+        }
+        if (site.allocations) {
+            function(site);
+        }
+    }
+
+private:
+    struct entry
+    {
+        void add_to(call_site & site) const noexcept
+        {
+            auto deallocations =
+                this->deallocations.load(std::memory_order_relaxed);
+            auto allocations =
+                this->allocations.load(std::memory_order_relaxed);
+            site.allocations += allocations;
+            site.bytes += bytes.load(std::memory_order_relaxed);
+            if (allocations > deallocations) {
+                site.live += allocations - deallocations;
+            }
+        }
+
+        std::atomic<const void *> address{};
+        std::atomic<std::size_t> frame_size{};
+        std::atomic<std::size_t> allocations{};
+
+        // Counted rather than derived from the frame size, since the
+        // overflow entry holds frames of any size.
+        std::atomic<std::size_t> bytes{};
+        std::atomic<std::size_t> deallocations{};
+    };
+
+    struct table
+    {
+        static std::size_t hash(const void * address,
+                                std::size_t size) noexcept
+        {
+            auto key = reinterpret_cast<std::uintptr_t>(address) ^
+                       (std::uintptr_t(size) << 17);
+            return std::size_t((key * 0x9e3779b97f4a7c15u) >> 32) %
+                   table_size;
+        }
+
+        /**
+         * Finds or inserts the entry of the site, called only by the
+         * thread owning the table.
+         */
+        entry & find(const void * address, std::size_t size) noexcept
+        {
+            auto index = hash(address, size);
+            for (std::size_t i = 0; i < table_size; ++i) {
+                auto & slot = entries[(index + i) % table_size];
+                auto existing =
+                    slot.address.load(std::memory_order_relaxed);
+                if (!existing) {
+                    slot.frame_size.store(size, std::memory_order_relaxed);
+                    slot.address.store(address, std::memory_order_release);
+                    return slot;
+                }
+                if (existing == address &&
+                    slot.frame_size.load(std::memory_order_relaxed) ==
+                        size) {
+                    return slot;
+                }
+            }
+            return overflow;
+        }
+
+        /**
+         * Returns the entry of the site if recorded, may be called from
+         * any thread.
+         */
+        const entry * lookup(const void * address,
+                             std::size_t size) const noexcept
+        {
+            auto index = hash(address, size);
+            for (std::size_t i = 0; i < table_size; ++i) {
+                auto & slot = entries[(index + i) % table_size];
+                auto existing =
+                    slot.address.load(std::memory_order_acquire);
+                if (!existing) {
+                    return nullptr;
+                }
+                if (existing == address &&
+                    slot.frame_size.load(std::memory_order_relaxed) ==
+                        size) {
+                    return &slot;
+                }
+            }
+            return nullptr;
+        }
+
+        entry entries[table_size]{};
+        entry overflow{};
+        table * next{};
+    };
+
+    /**
+     * Returns true if a table in the range [begin, end) recorded the site.
+     */
+    static bool contains(const table * begin,
+                         const table * end,
+                         const void * address,
+                         std::size_t size) noexcept
+    {
+        for (auto table = begin; table != end; table = table->next) {
+            if (table->lookup(address, size)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::atomic<table *> & tables() noexcept
+    {
+        static std::atomic<table *> tables;
+        return tables;
+    }
+
+    /**
+     * Tables are never freed, so that frames freed after their thread
+     * exits and sites of exited threads remain accounted for.
+     */
+    static table & local_table() noexcept
+    {
+        static thread_local table * local = [] {
+            auto table = ::new (std::nothrow) struct table;
+            if (!table) {
+                std::terminate();
+            }
+            table->next = tables().load(std::memory_order_relaxed);
+            while (!tables().compare_exchange_weak(
+                table->next,
+                table,
+                std::memory_order_release,
+                std::memory_order_relaxed)) {
+            }
+            return table;
+        }();
+        return *local;
+    }
+};
+
+/**
+ * A small process wide buffer that holds exception objects whose
+ * allocation failed, similar to the emergency pool of the C++ runtime,
+ * such that the thrown type survives memory pressure. Applies to
+ * allocators that return null on failure. Only when the buffer is
+ * exhausted as well, the exception becomes `std::errc::not_enough_memory`.
+ * Slots are claimed and freed with an atomic mask, so exceptions in the
+ * buffer may be freed on any thread, also after their thread exits.
+ */
+class emergency_exception_buffer
+{
+public:
+    /**
+     * The largest exception object held by the buffer.
+     */
+    static constexpr std::size_t slot_size = 256;
+
+    /**
+     * The number of exception objects the buffer holds at once.
+     */
+    static constexpr std::size_t slot_count = 4;
+
+    static_assert(slot_count <= 32, "The mask holds 32 slots.");
+
+    /**
+     * Usage statistics of the current thread.
+     */
+    struct statistics
+    {
+        std::size_t uses{};
+        std::size_t exhausted{};
+    };
+
+    /**
+     * Returns storage for an exception object of the given size, or
+     * null if it is too large or the buffer is exhausted.
+     */
+    static void * allocate(std::size_t size) noexcept
+    {
+        auto & stats = local_statistics();
+        if (size <= slot_size) {
+            auto mask = used.load(std::memory_order_relaxed);
+            for (std::size_t index = 0; index < slot_count;) {
+                std::uint32_t bit = std::uint32_t(1) << index;
+                if (mask & bit) {
+                    ++index;
+                    continue;
+                }
+
+                // On failure the mask is reloaded and the slot retried.
+                if (used.compare_exchange_weak(mask,
+                                               mask | bit,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+                    ++stats.uses;
+                    return slots[index].storage;
+                }
+            }
+        }
+        ++stats.exhausted;
+        return nullptr;
+    }
+
+    /**
+     * Frees storage returned by `allocate`, possibly on another thread.
+     */
+    static void deallocate(void * pointer) noexcept
+    {
+        auto index = std::size_t(reinterpret_cast<slot *>(pointer) - slots);
+        used.fetch_and(~(std::uint32_t(1) << index),
+                       std::memory_order_release);
+    }
+
+    /**
+     * Returns the usage statistics of the current thread.
+     */
+    static struct statistics statistics() noexcept
+    {
+        return local_statistics();
+    }
+
+    /**
+     * Returns the number of exception objects currently held in the
+     * buffer, by all threads.
+     */
+    static std::size_t in_use() noexcept
+    {
+        std::size_t count{};
+        for (auto mask = used.load(std::memory_order_relaxed); mask;
+             mask &= mask - 1) {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct slot
+    {
+        alignas(std::max_align_t) std::byte storage[slot_size];
+    };
+
+    static struct statistics & local_statistics() noexcept
+    {
+        static thread_local struct statistics stats{};
+        return stats;
+    }
+
+    static inline slot slots[slot_count];
+    static inline std::atomic<std::uint32_t> used{};
+};
+
+/**
+ * The number of freed exception objects of the given exception type
+ * that each thread keeps for reuse by the next throw of the same type,
+ * zero by default. Specialize to opt-in for hot exception types that are
+ * allocated with the default allocator:
+ * ```cpp
+ * template <>
+ * inline constexpr std::size_t
+ *     zpp::exception_cache_capacity<std::out_of_range> = 16;
+ * ```
+ */
+template <typename Exception>
+inline constexpr std::size_t exception_cache_capacity = 0;
+
+/**
+ * A bounded thread local cache of freed exception objects of the given
+ * exception type, see `zpp::exception_cache_capacity`. Exception objects
+ * are cached by the thread that frees them.
+ */
+template <typename Exception>
+class exception_cache
+{
+public:
+    /**
+     * The maximum number of cached exception objects per thread.
+     */
+    static constexpr std::size_t capacity =
+        exception_cache_capacity<Exception>;
+
+    /**
+     * Statistics of the current thread.
+     */
+    struct statistics
+    {
+        std::size_t reused{};
+        std::size_t allocated{};
+    };
+
+    /**
+     * Creates an exception object, reusing a cached one if possible.
+     */
+    template <typename Holder>
+    static Holder * create(auto &&... arguments)
+    {
+        auto & list = local_list<sizeof(Holder)>();
+        auto & stats = local_statistics();
+        void * storage{};
+        if (list.count) {
+            storage = list.blocks[--list.count];
+            ++stats.reused;
+        } else {
+            storage = ::operator new(sizeof(Holder));
+            ++stats.allocated;
+        }
+        return ::new (storage)
+            Holder(std::forward<decltype(arguments)>(arguments)...);
+    }
+
+    /**
+     * Destroys an exception object created by `create()`, and caches
+     * it unless the cache is full.
+     */
+    template <typename Holder>
+    static void destroy(Holder * holder) noexcept
+    {
+        holder->~Holder();
+        void * storage = holder;
+        auto & list = local_list<sizeof(Holder)>();
+        if (list.count == capacity) {
+            ::operator delete(storage);
+            return;
+        }
+        list.blocks[list.count++] = storage;
+    }
+
+    /**
+     * Returns the statistics of the current thread.
+     */
+    static struct statistics statistics() noexcept
+    {
+        return local_statistics();
+    }
+
+private:
+    template <std::size_t Size>
+    struct block_list
+    {
+        ~block_list()
+        {
+            while (count) {
+                ::operator delete(blocks[--count]);
+            }
+        }
+
+        void * blocks[capacity];
+        std::size_t count;
+    };
+
+    template <std::size_t Size>
+    static block_list<Size> & local_list() noexcept
+    {
+        static thread_local block_list<Size> list{};
+        return list;
+    }
+
+    static struct statistics & local_statistics() noexcept
+    {
+        static thread_local struct statistics stats;
+        return stats;
+    }
+};
+
+namespace detail
+{
+/**
+ * The allocator type used to allocate exception objects of coroutines
+ * whose frames are allocated with the given allocator.
+ */
+template <typename Allocator>
+struct exception_allocator
+{
+    using type = std::conditional_t<
+        std::is_void_v<Allocator> ||
+            std::is_same_v<Allocator, frame_recycler>,
+        global_heap,
+        Allocator>;
+};
+
+template <typename Allocator>
+struct exception_allocator<inline_frame_allocator<Allocator>>
+    : exception_allocator<Allocator>
+{
+};
+
+template <typename Allocator>
+using exception_allocator_t =
+    typename exception_allocator<Allocator>::type;
+
+/**
+ * True if exception objects are allocated with the global operator new
+ * when using the given allocator.
+ */
+template <typename Allocator>
+inline constexpr bool is_global_heap_v =
+    std::is_same_v<exception_allocator_t<Allocator>, global_heap>;
+
+/**
+ * True if the allocator has no state and can be default constructed
+ * when needed instead of being stored.
+ */
+template <typename Allocator>
+inline constexpr bool is_stateless_allocator_v =
+    std::is_empty_v<Allocator> && std::is_default_constructible_v<Allocator>;
+
+/**
+ * Storage of exception objects held inline by exit conditions.
+ */
+template <std::size_t Size, std::size_t Alignment>
+struct inline_exception_storage
+{
+    static constexpr std::size_t size = Size;
+    static constexpr std::size_t alignment = Alignment;
+
+    alignas(Alignment) std::byte data[Size];
+};
+
+template <std::size_t Alignment>
+struct inline_exception_storage<0, Alignment>
+{
+    static constexpr std::size_t size = 0;
+    static constexpr std::size_t alignment = Alignment;
+};
+
+using inline_exception_storage_t = inline_exception_storage<
+    std::size_t(ZPP_THROWING_INLINE_EXCEPTION_SIZE) != 0
+        ? sizeof(exception_object) + ZPP_THROWING_INLINE_EXCEPTION_SIZE
+        : 0,
+    ZPP_THROWING_INLINE_EXCEPTION_ALIGNMENT>;
+} // namespace detail
+
+template <typename Allocator>
+struct exception_object_delete
+{
+    void operator()(exception_object * pointer)
+    {
+        pointer->destroy();
+    }
+};
+
+template <typename Allocator>
+using exception_ptr =
+    std::unique_ptr<exception_object, exception_object_delete<Allocator>>;
+
+/**
+ * Creates an exception object of the given type with the allocator,
+ * the allocator is passed as the first constructor argument such that
+ * the object is able to free itself upon `destroy()`.
+ */
+template <typename Type, typename Allocator>
+auto make_exception_object(
+    const detail::exception_allocator_t<Allocator> & allocator,
+    auto &&... arguments)
+{
+    using allocator_type = detail::exception_allocator_t<Allocator>;
+    if constexpr (detail::is_global_heap_v<Allocator>) {
+        return static_cast<exception_object *>(new Type(
+            allocator, std::forward<decltype(arguments)>(arguments)...));
+    } else {
+        auto allocator_copy = allocator;
+        auto allocated =
+            detail::allocate_bytes(allocator_copy, sizeof(Type));
+        if (!allocated) {
+            return static_cast<exception_object *>(nullptr);
+        }
+
+        std::allocator_traits<allocator_type>::construct(
+            allocator_copy,
+            reinterpret_cast<Type *>(allocated),
+            allocator,
+            std::forward<decltype(arguments)>(arguments)...);
+
+        return static_cast<exception_object *>(
+            reinterpret_cast<Type *>(allocated));
+    }
+}
+
+namespace detail
+{
+union type_info_entry
+{
+    constexpr type_info_entry(std::size_t number) : number(number)
+    {
+    }
+
+    constexpr type_info_entry(const void * pointer) : pointer(pointer)
+    {
+    }
+
+    constexpr type_info_entry(void * (*function)(void *) noexcept) :
+        function(function)
+    {
+    }
+
+    std::size_t number;
+    const void * pointer;
+    void * (*function)(void *);
+};
+
+template <typename Type>
+constexpr auto type_id() noexcept -> const void *;
+
+template <typename... Types>
+struct type_list
+{
+};
+
+template <typename... Lists>
+struct concat_type_lists
+{
+    using type = type_list<>;
+};
+
+template <typename... Types>
+struct concat_type_lists<type_list<Types...>>
+{
+    using type = type_list<Types...>;
+};
+
+template <typename... First, typename... Second, typename... Lists>
+struct concat_type_lists<type_list<First...>, type_list<Second...>, Lists...>
+    : concat_type_lists<type_list<First..., Second...>, Lists...>
+{
+};
+
+/**
+ * The inheritance paths from the first type of `Path` through its last
+ * type to every transitive ancestor of the last type, in depth first
+ * order, where `Bases` are the bases of the last type.
+ */
+template <typename Path, typename Bases>
+struct ancestor_paths;
+
+template <typename... Path, typename... Bases>
+struct ancestor_paths<type_list<Path...>, define_exception_bases<Bases...>>
+{
+    using type = typename concat_type_lists<typename concat_type_lists<
+        type_list<type_list<Path..., Bases>>,
+        typename ancestor_paths<type_list<Path..., Bases>,
+                                define_exception_t<Bases>>::type>::type...>::
+        type;
+};
+
+template <typename Source>
+auto * static_cast_path(Source * source) noexcept
+{
+    return source;
+}
+
+template <typename Source, typename Next, typename... Rest>
+auto * static_cast_path(Source * source) noexcept
+{
+    return static_cast_path<Next, Rest...>(static_cast<Next *>(source));
+}
+
+/**
+ * Casts from the first type of the path to its last type, through
+ * every type of the path.
+ */
+template <typename Source, typename... Rest>
+void * erased_static_cast(void * source) noexcept
+{
+    return static_cast_path<Source, Rest...>(static_cast<Source *>(source));
+}
+
+template <typename... Path>
+constexpr auto make_erased_static_cast(type_list<Path...>) noexcept
+{
+    return &erased_static_cast<Path...>;
+}
+
+template <typename... Path>
+constexpr auto ancestor_type_id(type_list<Path...>) noexcept
+{
+    return type_id<std::tuple_element_t<sizeof...(Path) - 1,
+                                        std::tuple<Path...>>>();
+}
+
+template <typename Type, typename Paths>
+struct flat_type_information;
+
+template <typename Type, typename... Paths>
+struct flat_type_information<Type, type_list<Paths...>>
+{
+    // Construct the type information, listing every transitive ancestor
+    // such that matching scans the type ids without recursion, and
+    // adjusts the pointer of a match with a single cast.
+    static constexpr type_info_entry info[] = {
+        sizeof...(Paths),                    // Number of ancestors.
+        ancestor_type_id(Paths{})...,        // Ancestors type information.
+        make_erased_static_cast(Paths{})..., // Casts from derived to
+                                             // ancestor.
+    };
+};
+
+template <typename Type, typename... Bases>
+struct type_information
+    : flat_type_information<
+          Type,
+          typename ancestor_paths<type_list<Type>,
+                                  define_exception_bases<Bases...>>::type>
+{
+    static_assert((... && std::is_base_of_v<Bases, Type>),
+                  "Bases must be base classes of Type.");
+};
+
+template <typename Type>
+struct type_information<Type>
+{
+    // Construct the type information.
+    static constexpr type_info_entry info[] = {
+        std::size_t{}, // Number of ancestors.
+    };
+};
+
+template <typename Type, typename... Bases>
+constexpr auto type_id(define_exception_bases<Bases...>) noexcept
+{
+    return &type_information<Type, Bases...>::info;
+}
+
+template <typename Type>
+constexpr auto type_id(define_exception_bases<>) noexcept
+{
+    return &type_information<Type>::info;
+}
+
+template <typename Type>
+constexpr auto type_id() noexcept -> const void *
+{
+    using type = std::remove_cv_t<std::remove_reference_t<Type>>;
+    return detail::type_id<type>(define_exception_t<type>{});
+}
+
+/**
+ * Returns the entry of the cast from the most derived type to the base
+ * type within the type information of the most derived type, or null
+ * if the base is not an ancestor.
+ */
+inline const type_info_entry * find_ancestor_cast(const void * base,
+                                                  const void * most_derived)
+{
+    // Fetch the type info entries.
+    auto type_info_entries =
+        reinterpret_cast<const type_info_entry *>(most_derived);
+
+    // The number of ancestor types.
+    auto number_of_ancestors = type_info_entries->number;
+
+    // The ancestors type information.
+    auto ancestors = type_info_entries + 1;
+
+    for (std::size_t index = 0; index < number_of_ancestors; ++index) {
+        if (ancestors[index].pointer == base) {
+            // The erased static cast function matching ancestor.
+            return ancestors + number_of_ancestors + index;
+        }
+    }
+
+    // No conversion was found.
+    return nullptr;
+}
+
+inline void * dyn_cast(const void * base,
+                       void * most_derived_pointer,
+                       const void * most_derived)
+{
+    // If the most derived and the base are the same.
+    if (most_derived == base) {
+        return most_derived_pointer;
+    }
+
+    if (auto cast = find_ancestor_cast(base, most_derived)) {
+        return cast->function(most_derived_pointer);
+    }
+    return nullptr;
+}
+
+template <typename Type>
+struct catch_type
+    : catch_type<decltype(&std::remove_cv_t<
+                          std::remove_reference_t<Type>>::operator())>
+{
+};
+
+template <typename ReturnType, typename Argument>
+struct catch_type<ReturnType (*)(Argument)>
+{
+    using type = Argument;
+};
+
+template <typename Type, typename ReturnType, typename Argument>
+struct catch_type<ReturnType (Type::*)(Argument)>
+{
+    using type = Argument;
+};
+
+template <typename Type, typename ReturnType, typename Argument>
+struct catch_type<ReturnType (Type::*)(Argument) const>
+{
+    using type = Argument;
+};
+
+template <typename ReturnType, typename Argument>
+struct catch_type<ReturnType (*)(Argument) noexcept>
+{
+    using type = Argument;
+};
+
+template <typename Type, typename ReturnType, typename Argument>
+struct catch_type<ReturnType (Type::*)(Argument) noexcept>
+{
+    using type = Argument;
+};
+
+template <typename Type, typename ReturnType, typename Argument>
+struct catch_type<ReturnType (Type::*)(Argument) const noexcept>
+{
+    using type = Argument;
+};
+
+template <typename ReturnType>
+struct catch_type<ReturnType (*)()>
+{
+    using type = void;
+};
+
+template <typename Type, typename ReturnType>
+struct catch_type<ReturnType (Type::*)()>
+{
+    using type = void;
+};
+
+template <typename Type, typename ReturnType>
+struct catch_type<ReturnType (Type::*)() const>
+{
+    using type = void;
+};
+
+template <typename ReturnType>
+struct catch_type<ReturnType (*)() noexcept>
+{
+    using type = void;
+};
+
+template <typename Type, typename ReturnType>
+struct catch_type<ReturnType (Type::*)() noexcept>
+{
+    using type = void;
+};
+
+template <typename Type, typename ReturnType>
+struct catch_type<ReturnType (Type::*)() const noexcept>
+{
+    using type = void;
+};
+
+template <typename Type>
+using catch_type_t = typename catch_type<Type>::type;
+
+template <typename Type>
+struct catch_value_type
+{
+    using type =
+        std::remove_cv_t<std::remove_reference_t<catch_type_t<Type>>>;
+};
+
+template <typename Type>
+using catch_value_type_t = typename catch_value_type<Type>::type;
+
+/**
+ * True if the catch clause returns a `zpp::throwing`, and as such may
+ * itself throw.
+ */
+template <typename Clause, typename CatchType = catch_value_type_t<Clause>>
+inline constexpr bool is_throwing_clause_v =
+    requires {
+        typename std::invoke_result_t<Clause>::zpp_throwing_tag;
+    } ||
+    requires {
+        typename std::invoke_result_t<
+            Clause,
+            std::conditional_t<std::is_void_v<CatchType>, int, CatchType> &>::
+            zpp_throwing_tag;
+    };
+
+template <typename... Clauses>
+using last_clause_t =
+    std::tuple_element_t<sizeof...(Clauses) - 1, std::tuple<Clauses...>>;
+
+/**
+ * True if there is no catch all clause, or only the last one is.
+ */
+template <typename... Clauses>
+inline constexpr bool is_catch_all_last_v =
+    (... + std::size_t{std::is_void_v<catch_value_type_t<Clauses>>}) ==
+    std::is_void_v<catch_value_type_t<last_clause_t<Clauses...>>>;
+
+/**
+ * True if catching with the clauses may result in a `zpp::throwing`,
+ * that is, if a clause may throw or the last clause is not a catch all
+ * clause through which the exception could be rethrown.
+ */
+template <typename... Clauses>
+inline constexpr bool is_throwing_catch_v =
+    (... || is_throwing_clause_v<Clauses>) ||
+    !std::is_invocable_v<last_clause_t<Clauses...>>;
+
+/**
+ * The kind of a catch clause.
+ */
+enum class catch_kind : unsigned char
+{
+    any,
+    error,
+    error_code,
+    exception,
+};
+
+struct catch_clause
+{
+    // The kind of the clause.
+    catch_kind kind{};
+
+    // The error domain of an error code clause, or the type id of an
+    // exception clause.
+    const void * type{};
+};
+
+template <typename Clause, typename CatchType = catch_value_type_t<Clause>>
+constexpr catch_clause make_catch_clause() noexcept
+{
+    if constexpr (std::is_void_v<CatchType>) {
+        return {catch_kind::any};
+    } else if constexpr (std::is_invocable_v<Clause, error>) {
+        return {catch_kind::error};
+    } else if constexpr (requires { error{CatchType{}}; }) {
+        return {catch_kind::error_code,
+                static_cast<const error_domain *>(
+                    std::addressof(err_domain<CatchType>))};
+    } else if constexpr (requires { define_exception<CatchType>(); }) {
+        return {catch_kind::exception, type_id<CatchType>()};
+    } else {
+        static_assert(std::is_void_v<CatchType>, "Invalid catch clause.");
+    }
+}
+
+/**
+ * The catch clauses of a catch site.
+ */
+template <typename... Clauses>
+inline constexpr catch_clause catch_clauses[] = {
+    make_catch_clause<Clauses>()...};
+
+/**
+ * Memoizes the error code clauses of a catch site that catch errors of
+ * recently caught domains, such that a catch site with many error code
+ * clauses matches an error without scanning them. Each slot holds the
+ * first clause that catches the domain of the slot, whose domain
+ * identifies the slot, hence slots are single atomic pointers that are
+ * lock-free and thread-safe.
+ */
+class error_match_cache
+{
+public:
+    static constexpr std::size_t size = 4;
+
+    constexpr error_match_cache() noexcept = default;
+
+    /**
+     * Returns the clause that catches the domain, or null if unknown.
+     */
+    const catch_clause * find(const error_domain * domain) noexcept
+    {
+        // The catch clauses are constant, hence relaxed ordering.
+        auto cached = slot(domain).load(std::memory_order_relaxed);
+        if (cached && cached->type == domain) [[likely]] {
+            return cached;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Records the error code clause as catching its domain.
+     */
+    void store(const catch_clause * clause) noexcept
+    {
+        slot(clause->type).store(clause, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<const catch_clause *> & slot(const void * domain) noexcept
+    {
+        return m_slots[(reinterpret_cast<std::uintptr_t>(domain) /
+                        alignof(error_domain)) %
+                       size];
+    }
+
+    std::atomic<const catch_clause *> m_slots[size]{};
+};
+
+/**
+ * The error match cache of a catch site with several error code
+ * clauses, the clause types of which identify the catch site.
+ */
+template <typename... Clauses>
+inline constinit error_match_cache catch_site_error_match_cache{};
+
+/**
+ * The number of error code clauses.
+ */
+template <typename... Clauses>
+inline constexpr std::size_t error_code_clauses_v =
+    (... + std::size_t{make_catch_clause<Clauses>().kind ==
+                       catch_kind::error_code});
+
+/**
+ * True if the catch site first matches within itself before calling
+ * the shared matcher: sites with at most one clause besides a catch all
+ * clause, and sites without exception clauses, whose tables fold to a
+ * few comparisons that are cheaper than the call.
+ */
+template <typename... Clauses>
+inline constexpr bool is_inline_catch_site_v =
+    (... + std::size_t{make_catch_clause<Clauses>().kind !=
+                       catch_kind::any}) <= 1 ||
+    (... && (make_catch_clause<Clauses>().kind != catch_kind::exception));
+
+/**
+ * The index of the catch clause that matched, and the address of the
+ * caught exception as the catch type of the clause.
+ */
+struct catch_match
+{
+    std::size_t index{};
+    void * caught{};
+};
+
+/**
+ * Memoizes the matching of thrown exception types at a catch site, such
+ * that a catch site matches a recently thrown type with a single probe
+ * rather than scanning the ancestors of the type for every clause. Each
+ * slot maps the type information of a thrown type to the index of the
+ * first clause that catches it, or the number of clauses if none does,
+ * and the entry of the cast to the caught type if it is an ancestor.
+ * Slots span several words, hence each is guarded by a sequence number
+ * that readers validate and that a writer makes odd while it stores, so
+ * lookups are lock-free and thread-safe and racing stores are dropped.
+ */
+class exception_match_cache
+{
+public:
+    static constexpr std::size_t size = 4;
+
+    constexpr exception_match_cache() noexcept = default;
+
+    /**
+     * Returns true and the match of the exception if its type is known.
+     */
+    bool find(dynamic_object exception, catch_match & match) noexcept
+    {
+        auto & slot = this->slot(exception.type_id);
+        // Acquiring a stored word also acquires the odd sequence number
+        // that preceded it, which then fails the validation.
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        auto type_id = slot.type_id.load(std::memory_order_acquire);
+        auto index = slot.index.load(std::memory_order_acquire);
+        auto cast = slot.cast.load(std::memory_order_acquire);
+        if (type_id != exception.type_id || sequence % 2 ||
+            sequence != slot.sequence.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        match = {index,
+                 cast ? cast->function(exception.address)
+                      : exception.address};
+        return true;
+    }
+
+    /**
+     * Records the index of the clause that catches the thrown type and
+     * the cast to its caught type, unless another thread is storing.
+     */
+    void store(const void * type_id,
+               std::size_t index,
+               const type_info_entry * cast) noexcept
+    {
+        auto & slot = this->slot(type_id);
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        if (sequence % 2 ||
+            !slot.sequence.compare_exchange_strong(
+                sequence, sequence + 1, std::memory_order_relaxed)) {
+            return;
+        }
+
+        slot.type_id.store(type_id, std::memory_order_release);
+        slot.index.store(index, std::memory_order_release);
+        slot.cast.store(cast, std::memory_order_release);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    struct entry
+    {
+        std::atomic<std::size_t> sequence{};
+        std::atomic<const void *> type_id{};
+        std::atomic<std::size_t> index{};
+        std::atomic<const type_info_entry *> cast{};
+    };
+
+    entry & slot(const void * type_id) noexcept
+    {
+        return m_slots[(reinterpret_cast<std::uintptr_t>(type_id) /
+                        alignof(type_info_entry)) %
+                       size];
+    }
+
+    entry m_slots[size]{};
+};
+
+/**
+ * The exception match cache of a catch site with exception clauses, the
+ * clause types of which identify the catch site.
+ */
+template <typename... Clauses>
+inline constinit exception_match_cache catch_site_exception_match_cache{};
+
+/**
+ * The number of exception clauses.
+ */
+template <typename... Clauses>
+inline constexpr std::size_t exception_clauses_v =
+    (... + std::size_t{make_catch_clause<Clauses>().kind ==
+                       catch_kind::exception});
+
+/**
+ * Returns the first clause that catches the exception, or the error of
+ * the given domain if there is no exception, or the number of clauses
+ * if none does. Matching is shared by every catch site, rather than
+ * instantiated for each of them, to reduce code size. Catch sites with
+ * exception clauses pass an exception match cache, and catch sites with
+ * several error code clauses an error match cache.
+ */
+[[gnu::noinline]] inline catch_match
+match_catch_clause(const catch_clause * clauses,
+                   std::size_t size,
+                   dynamic_object exception,
+                   const error_domain * domain,
+                   exception_match_cache * exception_cache,
+                   error_match_cache * error_cache) noexcept
+{
+    if (exception.address) {
+        catch_match match;
+        if (exception_cache) {
+            if (exception_cache->find(exception, match)) [[likely]] {
+                return match;
+            }
+        }
+
+        // The cast to the caught type, null if it is the thrown type.
+        const type_info_entry * cast = nullptr;
+        std::size_t index = 0;
+        for (; index < size; ++index) {
+            auto & clause = clauses[index];
+            if (clause.kind == catch_kind::any) {
+                break;
+            } else if (clause.kind == catch_kind::exception) {
+                if (clause.type == exception.type_id) {
+                    break;
+                }
+                if ((cast = find_ancestor_cast(clause.type,
+                                               exception.type_id))) {
+                    break;
+                }
+            }
+        }
+
+        if (exception_cache) {
+            exception_cache->store(exception.type_id, index, cast);
+        }
+        return {index,
+                cast ? cast->function(exception.address)
+                     : exception.address};
+    } else {
+        if (error_cache) {
+            if (auto cached = error_cache->find(domain)) [[likely]] {
+                return {std::size_t(cached - clauses)};
+            }
+        }
+
+        for (std::size_t index = 0; index < size; ++index) {
+            auto & clause = clauses[index];
+            if (clause.kind == catch_kind::error_code &&
+                clause.type == domain) {
+                if (error_cache) {
+                    error_cache->store(std::addressof(clause));
+                }
+                return {index};
+            } else if (clause.kind == catch_kind::any ||
+                       clause.kind == catch_kind::error) {
+                return {index};
+            }
+        }
+    }
+    return {size};
+}
+
+/**
+ * Matches like `match_catch_clause` within catch sites for which it
+ * folds to a few comparisons, see `is_inline_catch_site_v`: exception
+ * clauses match only the exact type, and errors of several error code
+ * clauses only the cached domains. Returns false if the shared matcher
+ * must be called instead.
+ */
+[[gnu::always_inline]] inline bool
+match_catch_clause_inline(const catch_clause * clauses,
+                          std::size_t size,
+                          dynamic_object exception,
+                          const error_domain * domain,
+                          error_match_cache * error_cache,
+                          catch_match & match) noexcept
+{
+    if (exception.address) {
+        for (std::size_t index = 0; index < size; ++index) {
+            auto & clause = clauses[index];
+            if (clause.kind == catch_kind::any) {
+                match = {index, exception.address};
+                return true;
+            } else if (clause.kind == catch_kind::exception) {
+                if (clause.type != exception.type_id) {
+                    return false;
+                }
+                match = {index, exception.address};
+                return true;
+            }
+        }
+    } else if (error_cache) {
+        if (auto cached = error_cache->find(domain)) [[likely]] {
+            match = {std::size_t(cached - clauses)};
+            return true;
+        }
+        return false;
+    } else {
+        for (std::size_t index = 0; index < size; ++index) {
+            auto & clause = clauses[index];
+            if ((clause.kind == catch_kind::error_code &&
+                 clause.type == domain) ||
+                clause.kind == catch_kind::any ||
+                clause.kind == catch_kind::error) {
+                match = {index};
+                return true;
+            }
+        }
+    }
+    match = {size};
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * The arguments of an exception that is constructed in place within its
+ * exception object when thrown, see `zpp::make_exception()`.
+ */
+template <typename Exception, typename... Arguments>
+struct exception_emplacer
+{
+    std::tuple<Arguments &&...> arguments;
+};
+
+namespace detail
+{
+template <typename Type>
+inline constexpr bool is_exception_emplacer_v = false;
+
+template <typename Exception, typename... Arguments>
+inline constexpr bool
+    is_exception_emplacer_v<exception_emplacer<Exception, Arguments...>> =
+        true;
+} // namespace detail
+
+/**
+ * Throws an exception of the given type that is constructed from the
+ * arguments directly within the exception object, without a temporary
+ * that is moved into it. Non movable exceptions may be thrown this way.
+ * ```cpp
+ * co_yield zpp::make_exception<std::runtime_error>("Error.");
+ * ```
+ * The arguments are referenced until the exception is constructed, and
+ * must not be kept beyond the throwing expression.
+ */
+template <typename Exception, typename... Arguments>
+constexpr auto make_exception(Arguments &&... arguments) noexcept
+    requires requires { define_exception<Exception>(); }
+{
+    return exception_emplacer<Exception, Arguments...>{
+        std::forward_as_tuple(std::forward<Arguments>(arguments)...)};
+}
+
+namespace detail
+{
+/**
+ * The exception object of an exception, which is completed according
+ * to where it is stored. Objects that are not stored inline hold the
+ * context slot right after the header.
+ */
+template <typename Exception, bool HasContext>
+struct exception_value : public exception_object
+{
+    static_assert(alignof(Exception) <= 0x4000,
+                  "The alignment of the exception is too large.");
+
+    exception_value(manage_function * manage, auto & construct) :
+        exception_object(
+            type_id<Exception>(), offset_of(this), HasContext, manage),
+        m_exception(construct())
+    {
+    }
+
+    /**
+     * Moves an object stored inline, which is not shared and has no
+     * context.
+     */
+    exception_value(manage_function * manage,
+                    exception_value<Exception, false> && other) :
+        exception_object(
+            type_id<Exception>(), offset_of(this), HasContext, manage),
+        m_exception(relocate(other.m_exception))
+    {
+    }
+
+    // Only exceptions stored inline are moved, which are nothrow
+    // move constructible.
+    static Exception relocate(Exception & exception) noexcept
+    {
+        if constexpr (std::is_nothrow_move_constructible_v<Exception>) {
+            return std::move(exception);
+        } else {
+            std::terminate();
+        }
+    }
+
+    // The offset of the exception within the object, computed from
+    // addresses only, hence usable during construction.
+    static std::size_t offset_of(exception_value * self) noexcept
+    {
+        return std::size_t(
+            reinterpret_cast<std::byte *>(
+                std::addressof(self->m_exception)) -
+            reinterpret_cast<std::byte *>(
+                static_cast<exception_object *>(self)));
+    }
+
+    struct no_context
+    {
+    };
+
+    using context_type =
+        std::conditional_t<HasContext, error_context_block *, no_context>;
+
+    [[no_unique_address]] context_type m_context{};
+    Exception m_exception;
+};
+} // namespace detail
+
+/**
+ * The exit condition of the coroutine - A value, or error/exception.
+ */
+template <typename Type, typename Allocator>
+struct exit_condition
+{
+    using exception_type = exception_object *;
+    using error_type = class error;
+    using allocator_type = detail::exception_allocator_t<Allocator>;
+    using value_type = std::conditional_t<
+        std::is_void_v<Type>,
+        std::nullptr_t,
+        std::conditional_t<
+            std::is_reference_v<Type>,
+            std::add_pointer_t<std::remove_reference_t<Type>>,
+            Type>>;
+
+    constexpr exit_condition() noexcept :
+        m_error_domain(std::addressof(err_domain<rethrow_error>))
+    {
+    }
+
+    template <typename..., typename Dependent = Type>
+    constexpr explicit exit_condition(void_t) requires std::is_void_v<Dependent>
+        : m_error_domain(nullptr)
+    {
+    }
+
+    constexpr explicit exit_condition(auto && value) :
+        m_error_domain(nullptr),
+        m_return_value(std::forward<decltype(value)>(value))
+    {
+    }
+
+    constexpr exit_condition(exit_condition && other) noexcept
+    {
+        if (other.is_value()) {
+            if constexpr (!std::is_void_v<Type>) {
+                if constexpr (!std::is_reference_v<Type>) {
+                    ::new (std::addressof(m_return_value))
+                        Type(std::move(other.m_return_value));
+                } else {
+                    m_return_value = other.m_return_value;
+                }
+            }
+        } else {
+            m_error_domain = other.m_error_domain;
+            move_error(other);
+        }
+    }
+
+    constexpr ~exit_condition()
+    {
+        if constexpr (!std::is_void_v<Type> &&
+                      !std::is_trivially_destructible_v<Type>) {
+            if (is_value()) {
+                m_return_value.~Type();
+            }
+        }
+    }
+
+    constexpr bool is_exception() const noexcept
+    {
+        return m_error_domain ==
+               std::addressof(err_domain<throwing_exception>);
+    }
+
+    constexpr bool is_value() const noexcept
+    {
+        return !m_error_domain;
+    }
+
+    constexpr bool success() const noexcept
+    {
+        return !m_error_domain;
+    }
+
+    constexpr bool failure() const noexcept
+    {
+        return m_error_domain;
+    }
+
+    constexpr bool is_error() const noexcept
+    {
+        return !is_value() && !is_exception();
+    }
+
+    constexpr auto is_rethrow() const noexcept
+    {
+        return m_error_domain == std::addressof(err_domain<rethrow_error>);
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return success();
+    }
+
+    constexpr decltype(auto) value() && noexcept
+    {
+        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
+            return std::forward<Type>(m_return_value);
+        } else {
+            return std::forward<Type>(*m_return_value);
+        }
+    }
+
+    constexpr decltype(auto) value() & noexcept
+    {
+        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
+            return (m_return_value);
+        } else {
+            return (*m_return_value);
+        }
+    }
+
+    constexpr auto & exception() noexcept
+    {
+        return *m_error.exception;
+    }
+
+    constexpr auto error() const noexcept
+    {
+        return error_type{m_error.code, *m_error_domain};
+    }
+
+    /**
+     * Exits with a value.
+     * Must call exit functions exactly once.
+     */
+    template <typename..., typename Dependent = Type>
+    constexpr void
+    exit_with_value(auto && value) requires(!std::is_void_v<Dependent>)
+    {
+        if constexpr (!std::is_void_v<Type>) {
+            if constexpr (!std::is_reference_v<Type>) {
+                ::new (std::addressof(m_return_value))
+                    Type(std::forward<decltype(value)>(value));
+            } else {
+                m_return_value = std::addressof(value);
+            }
+        }
+        m_error_domain = nullptr;
+    }
+
+    template <typename..., typename Dependent = Type>
+    constexpr void exit_with_value() requires std::is_void_v<Dependent>
+    {
+        m_error_domain = nullptr;
+    }
+
+    /**
+     * Exits with exception, allocated with a default constructed
+     * allocator.
+     * Must call exit functions exactly once.
+     */
+    template <typename Exception>
+    auto exit_with_exception(Exception && exception) noexcept
+    {
+        return exit_with_exception(std::forward<Exception>(exception),
+                                   allocator_type{});
+    }
+
+    /**
+     * Exits with exception, allocated with the given allocator.
+     * Must call exit functions exactly once.
+     */
+    template <typename Exception>
+    auto exit_with_exception(Exception && exception,
+                             const allocator_type & allocator) noexcept
+    {
+        return exit_emplace_exception<
+            std::remove_cv_t<std::remove_reference_t<Exception>>>(
+            allocator, std::forward<Exception>(exception));
+    }
+
+    /**
+     * Exits with an exception constructed in place from the arguments of
+     * the emplacer, allocated with the given allocator.
+     * Must call exit functions exactly once.
+     */
+    template <typename Exception, typename... Arguments>
+    auto exit_with_exception(
+        exception_emplacer<Exception, Arguments...> && emplacer,
+        const allocator_type & allocator) noexcept
+    {
+        return std::apply(
+            [&](auto &&... arguments) {
+                return exit_emplace_exception<Exception>(
+                    allocator,
+                    std::forward<decltype(arguments)>(arguments)...);
+            },
+            std::move(emplacer.arguments));
+    }
+
+    /**
+     * Exits with an exception of the given type that is constructed
+     * from the arguments directly within the exception object, allocated
+     * with the given allocator.
+     * Must call exit functions exactly once.
+     */
+    template <typename Exception>
+    auto exit_emplace_exception(const allocator_type & allocator,
+                                auto &&... arguments) noexcept
+    {
+        // Constructs the exception, the returned prvalue initializes the
+        // exception within the exception object without a move.
+        auto construct = [&]() -> Exception {
+            return Exception(std::forward<decltype(arguments)>(arguments)...);
+        };
+        using construct_type = decltype(construct);
+
+        // The exception objects that will be type erased, which are
+        // completed below according to where they are stored.
+        using inline_exception_value =
+            detail::exception_value<Exception, false>;
+        using exception_value = detail::exception_value<Exception, true>;
+
+        m_error_domain = std::addressof(err_domain<throwing_exception>);
+
+        // Exception objects stored inline add no members, and are defined
+        // only when used since they move the exception.
+        if constexpr (sizeof(inline_exception_value) <=
+                          inline_storage_type::size &&
+                      alignof(inline_exception_value) <=
+                          inline_storage_type::alignment &&
+                      std::is_nothrow_move_constructible_v<Exception>) {
+            // The allocator is not stored with inline objects, hence those
+            // moved out of line are allocated with a default constructed
+            // allocator, or with the global heap for stateful allocators.
+            constexpr bool is_allocated =
+                !detail::is_global_heap_v<Allocator> &&
+                detail::is_stateless_allocator_v<allocator_type>;
+
+            // Define the exception object that an exception object stored
+            // inline is moved to when it is shared.
+            struct heap_exception_holder : public exception_value
+            {
+                heap_exception_holder(inline_exception_value && other) :
+                    exception_value(&erased_manage, std::move(other))
+                {
+                }
+
+                // Returns null if the allocation fails, in which case
+                // `other` is left intact.
+                static heap_exception_holder *
+                create(inline_exception_value & other) noexcept
+                {
+                    if constexpr (is_allocated) {
+                        allocator_type allocator{};
+                        auto allocated = detail::allocate_bytes(
+                            allocator, sizeof(heap_exception_holder));
+                        if (!allocated) [[unlikely]] {
+                            return nullptr;
+                        }
+                        return ::new (allocated)
+                            heap_exception_holder(std::move(other));
+                    } else {
+                        return new heap_exception_holder(std::move(other));
+                    }
+                }
+
+                static exception_object *
+                erased_manage(exception_object * object,
+                              exception_object::operation,
+                              void *) noexcept
+                {
+                    auto self = static_cast<heap_exception_holder *>(object);
+                    if constexpr (is_allocated) {
+                        self->~heap_exception_holder();
+                        allocator_type allocator{};
+                        detail::deallocate_bytes(
+                            allocator,
+                            reinterpret_cast<std::byte *>(self),
+                            sizeof(heap_exception_holder));
+                    } else {
+                        delete self;
+                    }
+                    return nullptr;
+                }
+            };
+
+            // Define the exception object that is stored inline.
+            struct inline_exception_holder : public inline_exception_value
+            {
+                inline_exception_holder(construct_type & construct) :
+                    inline_exception_value(&erased_manage, construct)
+                {
+                }
+
+                inline_exception_holder(
+                    inline_exception_holder && other) noexcept :
+                    inline_exception_value(&erased_manage, std::move(other))
+                {
+                }
+
+                static exception_object *
+                erased_manage(exception_object * object,
+                              exception_object::operation requested,
+                              void * storage) noexcept
+                {
+                    auto self = static_cast<inline_exception_holder *>(object);
+                    exception_object * moved{};
+                    if (requested == exception_object::operation::relocate) {
+                        moved = ::new (storage)
+                            inline_exception_holder(std::move(*self));
+                    } else if (requested ==
+                               exception_object::operation::move_to_heap) {
+                        moved = heap_exception_holder::create(*self);
+                        if (!moved) [[unlikely]] {
+                            return nullptr;
+                        }
+                    }
+                    self->~inline_exception_holder();
+                    return moved;
+                }
+            };
+
+            m_error.exception =
+                ::new (std::addressof(m_error.storage))
+                    inline_exception_holder(construct);
+            return;
+        }
+
+        // Exception objects allocated with the global heap may be cached
+        // per exception type.
+        constexpr bool is_cached =
+            detail::is_global_heap_v<Allocator> &&
+            exception_cache<Exception>::capacity != 0 &&
+            alignof(Exception) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        // Define the exception object that is allocated.
+        struct exception_holder : public exception_value
+        {
+            exception_holder(const allocator_type & allocator,
+                             construct_type & construct) :
+                exception_value(&erased_manage, construct),
+                m_allocator(allocator)
+            {
+            }
+
+            static exception_object *
+            erased_manage(exception_object * object,
+                          exception_object::operation,
+                          void *) noexcept
+            {
+                auto self = static_cast<exception_holder *>(object);
+                if constexpr (is_cached) {
+                    exception_cache<Exception>::destroy(self);
+                } else if constexpr (detail::is_global_heap_v<Allocator>) {
+                    delete self;
+                } else {
+                    // Move the allocator out before destroying the object.
+                    auto allocator = std::move(self->m_allocator);
+                    std::allocator_traits<allocator_type>::destroy(
+                        allocator, self);
+                    detail::deallocate_bytes(
+                        allocator,
+                        reinterpret_cast<std::byte *>(self),
+                        sizeof(exception_holder));
+                }
+                return nullptr;
+            }
+
+            [[no_unique_address]] allocator_type m_allocator;
+        };
+
+        if constexpr (is_cached) {
+            m_error.exception =
+                exception_cache<Exception>::template create<
+                    exception_holder>(allocator, construct);
+            return;
+        }
+
+        m_error.exception =
+            make_exception_object<exception_holder, Allocator>(allocator,
+                                                               construct);
+
+        if constexpr (detail::is_global_heap_v<Allocator>) {
+            // Nothing to be done.
+        } else if constexpr (noexcept(
+                                 std::declval<allocator_type>().allocate(
+                                     std::size_t{}))) {
+            if (m_error.exception) [[likely]] {
+                return;
+            }
+
+            // Define the exception object that is stored in the
+            // emergency buffer when allocation fails.
+            struct emergency_exception_holder : public exception_value
+            {
+                emergency_exception_holder(construct_type & construct) :
+                    exception_value(&erased_manage, construct)
+                {
+                }
+
+                static exception_object *
+                erased_manage(exception_object * object,
+                              exception_object::operation,
+                              void *) noexcept
+                {
+                    auto self =
+                        static_cast<emergency_exception_holder *>(object);
+                    self->~emergency_exception_holder();
+                    emergency_exception_buffer::deallocate(self);
+                    return nullptr;
+                }
+            };
+
+            if constexpr (alignof(emergency_exception_holder) <=
+                          alignof(std::max_align_t)) {
+                if (auto storage = emergency_exception_buffer::allocate(
+                        sizeof(emergency_exception_holder))) {
+                    m_error.exception = ::new (storage)
+                        emergency_exception_holder(construct);
+                    return;
+                }
+            }
+
+            exit_with_error(std::errc::not_enough_memory);
+        }
+    }
+
+    /**
+     * This must not hold a value or an exception.
+     * Must call exit functions exactly once.
+     */
+    constexpr void exit_rethrow() noexcept
+    {
+        m_error_domain = std::addressof(err_domain<rethrow_error>);
+    }
+
+    /**
+     * Exits with an error value.
+     * Must call exit functions exactly once.
+     */
+    constexpr void exit_with_error(const error_type & error) noexcept
+    {
+        m_error_domain = std::addressof(error.domain());
+        m_error.code = error.code();
+    }
+
+    /**
+     * Propagates an exception/error.
+     * Must call exit functions exactly once, `other` must have an
+     * error or an exception. Exception objects free themselves with
+     * the allocator they were created with, hence `other` may use
+     * a different allocator.
+     */
+    template <typename OtherType, typename OtherAllocator>
+    constexpr void exit_propagate(
+        exit_condition<OtherType, OtherAllocator> & other) noexcept
+    {
+        m_error_domain = other.m_error_domain;
+        move_error(other);
+    }
+
+    /**
+     * Exits with the error or exception of `other`, sharing its exception
+     * object by reference count rather than copying it. An exception
+     * object of `other` that is stored inline is moved out of line first,
+     * and if that fails, this exits with `std::errc::not_enough_memory`.
+     * Must call exit functions exactly once, `other` must have an
+     * error or an exception.
+     */
+    template <typename OtherType, typename OtherAllocator>
+    void
+    exit_share(exit_condition<OtherType, OtherAllocator> & other) noexcept
+    {
+        m_error_domain = other.m_error_domain;
+        if (!other.is_exception()) {
+            m_error.code = other.m_error.code;
+            return;
+        }
+
+        if (other.is_inline_exception()) {
+            auto moved = other.m_error.exception->move_to_heap();
+            if (!moved) [[unlikely]] {
+                exit_with_error(std::errc::not_enough_memory);
+                return;
+            }
+            other.m_error.exception = moved;
+        }
+        m_error.exception = other.m_error.exception->share();
+    }
+
+    /**
+     * Attaches a context message to the exception, which must be held.
+     * An exception object stored inline has no room for context, and
+     * is moved out of line first, the message is dropped if that fails.
+     */
+    void add_context(std::string_view message) noexcept
+    {
+        if (is_inline_exception()) [[unlikely]] {
+            auto moved = m_error.exception->move_to_heap();
+            if (!moved) [[unlikely]] {
+                return;
+            }
+            m_error.exception = moved;
+        }
+        m_error.exception->add_context(message);
+    }
+
+    /**
+     * Returns true if the exception object is stored inline.
+     */
+    bool is_inline_exception() const noexcept
+    {
+        if constexpr (!inline_storage_type::size) {
+            return false;
+        } else {
+            return reinterpret_cast<std::uintptr_t>(m_error.exception) -
+                       reinterpret_cast<std::uintptr_t>(
+                           std::addressof(m_error.storage)) <
+                   inline_storage_type::size;
+        }
+    }
+
+    /**
+     * Moves the error or exception of `other`, relocating the exception
+     * object if it is stored inline.
+     */
+    template <typename OtherType, typename OtherAllocator>
+    void
+    move_error(exit_condition<OtherType, OtherAllocator> & other) noexcept
+    {
+        if (other.is_exception() && other.is_inline_exception()) {
+            m_error.exception = other.m_error.exception->relocate(
+                std::addressof(m_error.storage));
+        } else {
+            std::memcpy(&m_error,
+                        &other.m_error,
+                        sizeof(exception_type) > sizeof(int)
+                            ? sizeof(exception_type)
+                            : sizeof(int));
+        }
+    }
+
+    using inline_storage_type = detail::inline_exception_storage_t;
+
+    struct error_storage
+    {
+        union
+        {
+            int code;
+            exception_type exception;
+        };
+        [[no_unique_address]] inline_storage_type storage;
+    };
+
+    const error_domain * m_error_domain{};
+    union
+    {
+        error_storage m_error;
+        value_type m_return_value;
+    };
+};
+
+/**
+ * Use as the return type of the function, throw exceptions
+ * by using `co_yield` / `co_return`. Using `co_yield` is clearer
+ * but in some cases may generate less code than `co_return`.
+ * If you want to throw exceptions using `co_return` in void returning
+ * functions, use `zpp::throwing<zpp::void_t>` instead, and `co_return
+ * zpp::void_v` to exit normally). Call throwing functions by `co_await`,
+ * and return values using `co_return`. Use the `zpp::try_catch` function
+ * to execute a function object and then to catch exceptions thrown from
+ * it.
+ */
+template <typename Type, typename Allocator = void>
+class ZPP_THROWING_CORO_AWAIT_ELIDABLE [[nodiscard]] throwing
+{
+public:
+    template <typename, typename>
+    friend class throwing;
+
+    struct zpp_throwing_tag
+    {
+    };
+
+    /**
+     * The promise type to be extended with return value / return void
+     * functionality.
+     */
+    class basic_promise_type
+    {
+    public:
+        template <typename, typename>
+        friend class throwing;
+
+        using allocator_type =
+            typename exit_condition<Type, Allocator>::allocator_type;
+
+        basic_promise_type() = default;
+
+        /**
+         * Construct with the allocator of a coroutine whose leading
+         * parameters are `std::allocator_arg_t, const Allocator &`.
+         */
+        template <typename... Arguments>
+        basic_promise_type(std::allocator_arg_t,
+                           const allocator_type & allocator,
+                           Arguments &...) :
+            m_allocator(allocator)
+        {
+        }
+
+        /**
+         * Construct with the allocator of a member function coroutine
+         * whose leading parameters are
+         * `std::allocator_arg_t, const Allocator &`.
+         */
+        template <typename This, typename... Arguments>
+        basic_promise_type(This &,
+                           std::allocator_arg_t,
+                           const allocator_type & allocator,
+                           Arguments &...) :
+            m_allocator(allocator)
+        {
+        }
+
+        struct suspend_destroy
+        {
+            constexpr bool await_ready() noexcept { return false; }
+            void await_suspend(auto handle) noexcept { handle.destroy(); }
+            [[noreturn]] void await_resume() noexcept { while (true); }
+        };
+
+        auto get_return_object()
+        {
+            return throwing{static_cast<promise_type &>(*this)};
+        }
+
+        auto initial_suspend() noexcept
+        {
+            return suspend_never{};
+        }
+
+        auto final_suspend() noexcept
+        {
+            return suspend_never{};
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+
+        /**
+         * Throw and destroy calling coroutine.
+         */
+        template <typename Value>
+        auto yield_value(Value && value)
+        {
+            throw_it(std::forward<Value>(value));
+            return suspend_destroy{};
+        }
+
+        /**
+         * Throw an exception.
+         */
+        template <typename Value>
+        void throw_it(Value && value) requires requires
+        {
+            define_exception<
+                std::remove_cv_t<std::remove_reference_t<Value>>>();
+        }
+        {
+            m_return_object->m_condition.exit_with_exception(
+                std::forward<Value>(value), m_allocator);
+        }
+
+        /**
+         * Throw an exception constructed in place.
+         */
+        template <typename Exception, typename... Arguments>
+        void throw_it(exception_emplacer<Exception, Arguments...> && emplacer)
+        {
+            m_return_object->m_condition.exit_with_exception(
+                std::move(emplacer), m_allocator);
+        }
+
+        /**
+         * Rethrow from existing.
+         */
+        template <typename ExitCondition>
+        void throw_it(
+            std::tuple<const rethrow_t &, ExitCondition &> error_condition)
+        {
+            m_return_object->m_condition.exit_propagate(
+                std::get<1>(error_condition));
+        }
+
+        /**
+         * Rethrow the current set exception.
+         */
+        void throw_it(rethrow_t)
+        {
+            m_return_object->m_condition.exit_rethrow();
+        }
+
+        /**
+         * Throw an error.
+         */
+        void throw_it(const error & error)
+        {
+            m_return_object->m_condition.exit_with_error(error);
+        }
+
+    protected:
+        ~basic_promise_type() = default;
+
+        throwing * m_return_object{};
+        [[no_unique_address]] allocator_type m_allocator{};
+    };
+
+    template <typename Base>
+    struct throwing_allocator : public Base
+    {
+        using Base::Base;
+
+        void * operator new(std::size_t size)
+        {
+            return allocate_frame(size, Allocator{});
+        }
+
+        template <typename... Arguments>
+        void * operator new(std::size_t size,
+                            std::allocator_arg_t,
+                            const Allocator & allocator,
+                            Arguments &...)
+        {
+            return allocate_frame(size, allocator);
+        }
+
+        template <typename This, typename... Arguments>
+        void * operator new(std::size_t size,
+                            This &,
+                            std::allocator_arg_t,
+                            const Allocator & allocator,
+                            Arguments &...)
+        {
+            return allocate_frame(size, allocator);
+        }
+
+        void operator delete(void * pointer, std::size_t size) noexcept
+        {
+            deallocate_frame(pointer, size);
+        }
+
+    protected:
+        ~throwing_allocator() = default;
+    };
+
+    template <typename Base>
+    struct noexcept_allocator : public Base
+    {
+        using Base::Base;
+
+        void * operator new(std::size_t size) noexcept
+        {
+            return allocate_frame(size, Allocator{});
+        }
+
+        template <typename... Arguments>
+        void * operator new(std::size_t size,
+                            std::allocator_arg_t,
+                            const Allocator & allocator,
+                            Arguments &...) noexcept
+        {
+            return allocate_frame(size, allocator);
+        }
+
+        template <typename This, typename... Arguments>
+        void * operator new(std::size_t size,
+                            This &,
+                            std::allocator_arg_t,
+                            const Allocator & allocator,
+                            Arguments &...) noexcept
+        {
+            return allocate_frame(size, allocator);
+        }
+
+        void operator delete(void * pointer, std::size_t size) noexcept
+        {
+            deallocate_frame(pointer, size);
+        }
+
+        static auto get_return_object_on_allocation_failure()
+        {
+            return throwing(nullptr);
+        }
+
+    protected:
+        ~noexcept_allocator() = default;
+    };
+
+    template <typename Base>
+    struct recycling_allocator : public Base
+    {
+        using Base::Base;
+
+        void * operator new(std::size_t size)
+        {
+            return frame_recycler::allocate(size);
+        }
+
+        void operator delete(void * pointer, std::size_t size) noexcept
+        {
+            frame_recycler::deallocate(pointer, size);
+        }
+
+    protected:
+        ~recycling_allocator() = default;
+    };
+
+#ifdef ZPP_THROWING_PROFILE_FRAMES
+    /**
+     * Records the frames allocated by base in `zpp::frame_profiler`.
+     */
+    template <typename Base>
+    struct profiling_allocator : public Base
+    {
+        using Base::Base;
+
+        [[gnu::noinline]] void *
+        operator new(std::size_t size) noexcept(is_noexcept_allocator)
+        {
+            auto allocated_size = frame_profiler::header_size + size;
+            void * allocated{};
+            if constexpr (std::is_void_v<Allocator>) {
+                allocated = ::operator new(allocated_size);
+            } else {
+                allocated = Base::operator new(allocated_size);
+            }
+            return record_frame(
+                allocated, size, __builtin_return_address(0));
+        }
+
+        template <typename... Arguments>
+        requires(sizeof...(Arguments) != 0 &&
+                 requires(std::size_t size, Arguments &... arguments) {
+                     Base::operator new(size, arguments...);
+                 })
+            [[gnu::noinline]] void * operator new(
+                std::size_t size,
+                Arguments &... arguments) noexcept(is_noexcept_allocator)
+        {
+            return record_frame(
+                Base::operator new(frame_profiler::header_size + size,
+                                   arguments...),
+                size,
+                __builtin_return_address(0));
+        }
+
+        void operator delete(void * pointer, std::size_t size) noexcept
+        {
+            auto allocated = frame_profiler::deallocated(pointer);
+            if constexpr (std::is_void_v<Allocator>) {
+                ::operator delete(allocated,
+                                  frame_profiler::header_size + size);
+            } else {
+                Base::operator delete(allocated,
+                                      frame_profiler::header_size + size);
+            }
+        }
+
+    protected:
+        ~profiling_allocator() = default;
+
+    private:
+        static void * record_frame(void * allocated,
+                                   std::size_t size,
+                                   const void * address) noexcept
+        {
+            if (!allocated) {
+                return nullptr;
+            }
+            return frame_profiler::allocated(allocated, size, address);
+        }
+    };
+#endif
+
+    /**
+     * Add the return void functionality to base.
+     */
+    template <typename Base>
+    struct promise_type_void : public Base
+    {
+        using Base::Base;
+
+        void return_void()
+        {
+            Base::m_return_object->m_condition.exit_with_value();
+        }
+    };
+
+    /**
+     * Add the return value functionality to base.
+     */
+    template <typename Base>
+    struct promise_type_nonvoid : public Base
+    {
+        using Base::Base;
+
+        template <typename T>
+        void return_value(T && value)
+        {
+            if constexpr (requires {
+                              Base::throw_it(std::forward<T>(value));
+                          }) {
+                Base::throw_it(std::forward<T>(value));
+            } else {
+                Base::m_return_object->m_condition.exit_with_value(
+                    std::forward<T>(value));
+            }
+        }
+    };
+
+    static constexpr bool is_noexcept_allocator =
+        noexcept(std::declval<std::conditional_t<std::is_void_v<Allocator>,
+                                                 std::allocator<std::byte>,
+                                                 Allocator>>()
+                     .allocate(std::size_t{}));
+
+    /**
+     * The basic promise type extended with the allocation strategy
+     * of the coroutine frame.
+     */
+    using selected_promise_type = std::conditional_t<
+        std::is_void_v<Allocator>,
+        basic_promise_type,
+        std::conditional_t<
+            std::is_same_v<Allocator, frame_recycler>,
+            recycling_allocator<basic_promise_type>,
+            std::conditional_t<is_noexcept_allocator,
+                               noexcept_allocator<basic_promise_type>,
+                               throwing_allocator<basic_promise_type>>>>;
+
+    /**
+     * The promise type that allocates the coroutine frame, profiled
+     * when frame profiling is enabled.
+     */
+#ifdef ZPP_THROWING_PROFILE_FRAMES
+    using allocating_promise_type =
+        profiling_allocator<selected_promise_type>;
+#else
+    using allocating_promise_type = selected_promise_type;
+#endif
+
+    /**
+     * The actual promise type, which adds the appropriate
+     * return strategy to the basic promise type.
+     */
+    using promise_type =
+        std::conditional_t<std::is_void_v<Type>,
+                           promise_type_void<allocating_promise_type>,
+                           promise_type_nonvoid<allocating_promise_type>>;
+
+    /**
+     * Constructor for out of memory scenario.
+     */
+    constexpr explicit throwing(std::nullptr_t) noexcept
+    {
+        m_condition.exit_with_error(std::errc::not_enough_memory);
+    }
+
+    /**
+     * Construct from the coroutine handle.
+     */
+    constexpr explicit throwing(promise_type & promise) noexcept
+    {
+        promise.m_return_object = this;
+    }
+
+    /**
+     * Construct directly from a value.
+     */
+    constexpr throwing(auto && value) requires(
+        std::is_convertible_v<decltype(value), Type> &&
+        !requires(promise_type & promise) {
+            promise.throw_it(std::forward<decltype(value)>(value));
+        }) ||
+        (std::is_void_v<Type> &&
+         std::is_same_v<
+             std::remove_cv_t<std::remove_reference_t<decltype(value)>>,
+             void_t>) :
+        m_condition(std::forward<decltype(value)>(value))
+    {
+    }
+
+    /**
+     * Construct directly from an error/exception.
+     */
+    constexpr throwing(auto && value) requires requires(promise_type & promise)
+    {
+        promise.throw_it(std::forward<decltype(value)>(value));
+    }
+    {
+        if constexpr (requires {
+                          define_exception<std::remove_cv_t<
+                              std::remove_reference_t<decltype(value)>>>();
+                      } ||
+                      detail::is_exception_emplacer_v<std::remove_cv_t<
+                          std::remove_reference_t<decltype(value)>>>) {
+            m_condition.exit_with_exception(
+                std::forward<decltype(value)>(value));
+        } else {
+            m_condition.exit_with_error(
+                std::forward<decltype(value)>(value));
+        }
+    }
+
+    /**
+     * Rethrow an exception.
+     */
+    constexpr throwing(rethrow_t) noexcept
+    {
+    }
+
+    /**
+     * Await is ready if there is no exception.
+     */
+    constexpr bool await_ready() noexcept
+    {
+        return m_condition.success();
+    }
+
+    /**
+     * Suspend execution only if there is an exception to be thrown.
+     */
+    template <typename PromiseType>
+    void await_suspend(coroutine_handle<PromiseType> outer_handle) noexcept
+    {
+        outer_handle.promise().m_return_object->m_condition.exit_propagate(
+            m_condition);
+        outer_handle.destroy();
+    }
+
+    /**
+     * Return the stored value on resume.
+     */
+    decltype(auto) await_resume() noexcept
+    {
+        if constexpr (std::is_void_v<Type>) {
+            return;
+        } else {
+            return std::move(m_condition).value();
+        }
+    }
+
+    /**
+     * Returns true if value is stored, otherwise, an
+     * exception/error is stored.
+     */
+    constexpr explicit operator bool() const noexcept
+    {
+        return m_condition.success();
+    }
+
+    /**
+     * Returns true if value is stored, otherwise, an
+     * exception/error is stored.
+     */
+    constexpr bool success() const noexcept
+    {
+        return m_condition.success();
+    }
+
+    /**
+     * Returns true if exception/error is stored, otherwise,
+     * value is stored.
+     */
+    constexpr bool failure() const noexcept
+    {
+        return m_condition.failure();
+    }
+
+    /**
+     * Returns the stored value, the behavior
+     * is undefined if there is an exception/error stored.
+     */
+    constexpr decltype(auto) value() && noexcept
+    {
+        if constexpr (std::is_void_v<Type>) {
+            return;
+        } else {
+            return std::move(m_condition).value();
+        }
+    }
+
+    /**
+     * Returns the stored value, the behavior
+     * is undefined if there is an exception/error stored.
+     */
+    constexpr decltype(auto) value() & noexcept
+    {
+        if constexpr (std::is_void_v<Type>) {
+            return;
+        } else {
+            return m_condition.value();
+        }
+    }
+
+    /**
+     * Returns a copy of the result. A stored value is copied, whereas a
+     * stored exception object is shared by reference count between both
+     * results, and destroyed when the last of them is caught. This
+     * allows delivering one failure to many consumers, such as waiters
+     * of the same cached or deduplicated operation, each of which must
+     * catch or propagate its copy. An exception stored inline is first
+     * moved out of line, with the allocator if it is stateless, and
+     * with the global operator new otherwise. If that fails, the copy
+     * holds `std::errc::not_enough_memory`.
+     */
+    constexpr throwing share() noexcept(
+        std::is_void_v<Type> || std::is_reference_v<Type> ||
+        std::is_nothrow_copy_constructible_v<Type>)
+    {
+        throwing result{rethrow};
+        if (m_condition.failure()) {
+            result.m_condition.exit_share(m_condition);
+        } else if constexpr (std::is_void_v<Type>) {
+            result.m_condition.exit_with_value();
+        } else {
+            result.m_condition.exit_with_value(m_condition.value());
+        }
+        return result;
+    }
+
+    /**
+     * Attaches a context message, such as "while loading shard", to the
+     * exception of a failed result as it propagates:
+     * ```cpp
+     * co_await load_shard(index).context("while loading shard");
+     * ```
+     * Catch clauses of the exception read the messages with
+     * `zpp::current_error_context()`. The messages are stored in linked
+     * segments of the exception object, and must have static storage
+     * duration. An exception stored inline is moved out of line by the
+     * first message, which takes one allocation.
+     * Error values that are not exceptions carry no context. Exceptions
+     * shared by `share()` keep the context attached before they were
+     * shared, but further messages are ignored, as the exception object
+     * is common to every copy of the result.
+     */
+    constexpr throwing && context(std::string_view message) && noexcept
+    {
+        if (m_condition.is_exception()) [[unlikely]] {
+            m_condition.add_context(message);
+        }
+        return std::move(*this);
+    }
+
+private:
+    /**
+     * Allows to catch exceptions. Each parameter is a catch clause
+     * that receives one parameter of the exception to be caught. A
+     * catch clause may itself be throwing. The last catch clause may
+     * have no parameters and as such catches all exceptions. Must
+     * return a value of the same type as the previously executed
+     * coroutine that is being checked for exceptions. This overload is
+     * for catch clauses that may themselves throw.
+     */
+    template <typename... Clauses>
+    requires detail::is_throwing_catch_v<Clauses...>
+    constexpr throwing catch_exception_object(const dynamic_object & exception,
+                                              Clauses &&... clauses)
+    {
+        static_assert(detail::is_catch_all_last_v<Clauses...>,
+                      "Catch all clause must be the last one.");
+
+        auto match = match_catch_clause<Clauses...>(exception);
+        if (match.index == sizeof...(Clauses)) {
+            return std::move(*this);
+        }
+
+        return catch_with_clause<throwing>(
+            match.index, match.caught, std::forward<Clauses>(clauses)...);
+    }
+
+    /**
+     * Allows to catch exceptions. Each parameter is a catch clause
+     * that receives one parameter of the exception to be caught. A
+     * catch clause may itself be throwing. The last catch clause may
+     * have no parameters and as such catches all exceptions. Must
+     * return a value of the same type as the previously executed
+     * coroutine that is being checked for exceptions. This overload is
+     * for catch clauses that cannot throw.
+     */
+    template <typename... Clauses>
+    requires(!detail::is_throwing_catch_v<Clauses...>)
+    constexpr Type catch_exception_object(const dynamic_object & exception,
+                                          Clauses &&... clauses)
+    {
+        static_assert(detail::is_catch_all_last_v<Clauses...>,
+                      "Catch all object with no parameters must "
+                      "be the last one.");
+
+        // The last clause catches all, hence always matches.
+        auto match = match_catch_clause<Clauses...>(exception);
+        return catch_with_clause<Type>(
+            match.index, match.caught, std::forward<Clauses>(clauses)...);
+    }
+
+    /**
+     * Returns the index of the clause that catches the exception or
+     * error, see `detail::match_catch_clause`.
+     */
+    template <typename... Clauses>
+    detail::catch_match
+    match_catch_clause(const dynamic_object & exception) noexcept
+    {
+        auto clauses =
+            detail::catch_clauses<std::remove_cvref_t<Clauses>...>;
+        auto domain = exception.address
+                          ? nullptr
+                          : std::addressof(m_condition.error().domain());
+        auto exception_cache =
+            detail::exception_clauses_v<std::remove_cvref_t<Clauses>...>
+                ? std::addressof(detail::catch_site_exception_match_cache<
+                                 std::remove_cvref_t<Clauses>...>)
+                : nullptr;
+        auto error_cache =
+            detail::error_code_clauses_v<std::remove_cvref_t<Clauses>...> > 1
+                ? std::addressof(detail::catch_site_error_match_cache<
+                                 std::remove_cvref_t<Clauses>...>)
+                : nullptr;
+
+        if constexpr (detail::is_inline_catch_site_v<
+                          std::remove_cvref_t<Clauses>...>) {
+            detail::catch_match match;
+            if (detail::match_catch_clause_inline(clauses,
+                                                  sizeof...(Clauses),
+                                                  exception,
+                                                  domain,
+                                                  error_cache,
+                                                  match)) [[likely]] {
+                return match;
+            }
+        }
+
+        return detail::match_catch_clause(clauses,
+                                          sizeof...(Clauses),
+                                          exception,
+                                          domain,
+                                          exception_cache,
+                                          error_cache);
+    }
+
+    /**
+     * Calls the clause of the given index.
+     */
+    template <typename Result, typename Clause, typename... Clauses>
+    constexpr Result catch_with_clause(std::size_t index,
+                                       void * caught,
+                                       Clause && clause,
+                                       Clauses &&... clauses)
+    {
+        if constexpr (0 != sizeof...(Clauses)) {
+            if (index) {
+                return catch_with_clause<Result>(
+                    index - 1, caught, std::forward<Clauses>(clauses)...);
+            }
+        }
+
+        return catch_with_clause<Result>(caught,
+                                         std::forward<Clause>(clause));
+    }
+
+    /**
+     * Calls the clause with the caught exception or error, and disposes
+     * of the exception unless it is rethrown. `Result` is `throwing` if
+     * catching may rethrow, otherwise `Type`.
+     */
+    template <typename Result, typename Clause>
+    constexpr Result catch_with_clause(void * caught, Clause && clause)
+    {
+        using catch_type = detail::catch_value_type_t<Clause>;
+        constexpr auto kind =
+            detail::make_catch_clause<std::remove_cvref_t<Clause>>().kind;
+        constexpr bool catches_exception =
+            kind == detail::catch_kind::any ||
+            kind == detail::catch_kind::exception;
+
+        auto call = [&]() -> decltype(auto) {
+            if constexpr (kind == detail::catch_kind::any) {
+                return std::forward<Clause>(clause)();
+            } else if constexpr (kind == detail::catch_kind::error) {
+                return std::forward<Clause>(clause)(m_condition.error());
+            } else if constexpr (kind == detail::catch_kind::error_code) {
+                return std::forward<Clause>(clause)(
+                    catch_type{m_condition.error().code()});
+            } else {
+                return std::forward<Clause>(clause)(
+                    *static_cast<catch_type *>(caught));
+            }
+        };
+
+        // Catch all clauses also catch errors, which are not exceptions.
+        exception_object * exception = nullptr;
+        if constexpr (catches_exception) {
+            if (caught) {
+                exception = std::addressof(m_condition.exception());
+            }
+        }
+
+        if constexpr (detail::is_throwing_clause_v<Clause>) {
+            auto result = [&] {
+                if constexpr (catches_exception) {
+                    detail::error_context_scope context_scope(exception);
+                    return call();
+                } else {
+                    return call();
+                }
+            }();
+            if (!result.is_rethrow()) [[likely]] {
+                if (exception) {
+                    exception_ptr<Allocator>{exception};
+                }
+                return result;
+            } else [[unlikely]] {
+                return std::move(*this);
+            }
+        } else if constexpr (kind == detail::catch_kind::any) {
+            detail::error_context_block * context{};
+            if (exception) {
+                context = exception->release_context();
+                exception_ptr<Allocator>{exception};
+            }
+            detail::error_context_scope context_scope(context);
+            return catch_result<Result>(call);
+        } else if constexpr (kind == detail::catch_kind::exception) {
+            exception_ptr<Allocator> exception_disposer(exception);
+            detail::error_context_scope context_scope(
+                exception_disposer.get());
+            return catch_result<Result>(call);
+        } else {
+            return catch_result<Result>(call);
+        }
+    }
+
+    /**
+     * Returns the result of the call, a void result of a catch clause
+     * is returned as `zpp::void_v` from a throwing catch.
+     */
+    template <typename Result>
+    static constexpr Result catch_result(auto & call)
+    {
+        if constexpr (std::is_void_v<decltype(call())> &&
+                      !std::is_void_v<Result>) {
+            call();
+            return void_v;
+        } else {
+            return call();
+        }
+    }
+
+    /**
+     * Returns true if rethrowing, else false.
+     */
+    constexpr bool is_rethrow() const noexcept
+    {
+        return m_condition.is_rethrow();
+    }
+
+public:
+    /**
+     * Allows to catch exceptions. Each parameter is a catch clause
+     * that receives one parameter of the exception to be caught. A
+     * catch clause may itself be throwing. The last catch clause may
+     * have no parameters and as such catches all exceptions. Must
+     * return a value of the same type as the previously executed
+     * coroutine that is being checked for exceptions. This overload is
+     * for catch clauses that may themselves throw.
+     */
+    template <typename... Clauses>
+    constexpr inline throwing
+    catches(Clauses &&... clauses) requires requires
+    {
+        typename decltype(this->catch_exception_object(
+            exception_object::null_dynamic_object,
+            std::forward<Clauses>(clauses)...))::zpp_throwing_tag;
+    }
+    {
+        // If there is no exception, skip.
+        if (m_condition) [[likely]] {
+            return std::move(*this);
+        } else [[unlikely]] {
+            // Follow to catch the exception.
+            return catch_exception_object(
+                // Increase chance `catches` gets inlined.
+                [&] {
+                    return m_condition.is_exception()
+                               ? m_condition.exception().dynamic_object()
+                               : exception_object::null_dynamic_object;
+                }(),
+                std::forward<Clauses>(clauses)...);
+        }
+    }
+
+    /**
+     * Allows to catch exceptions. Each parameter is a catch clause
+     * that receives one parameter of the exception to be caught. A
+     * catch clause may itself be throwing. The last catch clause may
+     * have no parameters and as such catches all exceptions. Must
+     * return a value of the same type as the previously executed
+     * coroutine that is being checked for exceptions. This overload is
+     * for catch clauses that do not throw.
+     */
+    template <typename... Clauses>
+    constexpr inline Type
+    catches(Clauses &&... clauses) requires(!requires {
+        typename decltype(this->catch_exception_object(
+            exception_object::null_dynamic_object,
+            std::forward<Clauses>(clauses)...))::zpp_throwing_tag;
+    })
+    {
+        // If there is no exception, skip.
+        if (m_condition) [[likely]] {
+            if constexpr (std::is_void_v<Type>) {
+                return;
+            } else {
+                return std::move(*this).value();
+            }
+        } else [[unlikely]] {
+            // Follow to catch the exception.
+            return catch_exception_object(
+                // Increase chance `catches` gets inlined.
+                [&] {
+                    return m_condition.is_exception()
+                               ? m_condition.exception().dynamic_object()
+                               : exception_object::null_dynamic_object;
+                }(),
+                std::forward<Clauses>(clauses)...);
+        }
+    }
+
+private :
+    /**
+     * Returns the offset past the coroutine frame of the given size
+     * where the allocator is stored.
+     */
+    static constexpr std::size_t allocator_offset(std::size_t size) noexcept
+    {
+        return (size + alignof(Allocator) - 1) & ~(alignof(Allocator) - 1);
+    }
+
+    /**
+     * Allocates a coroutine frame with the allocator, stateful allocators
+     * are stored past the end of the frame to be used for deallocation.
+     */
+    static void * allocate_frame(std::size_t size,
+                                 const auto & allocator) noexcept(
+        is_noexcept_allocator)
+    {
+        Allocator allocator_copy = allocator;
+        if constexpr (detail::is_stateless_allocator_v<Allocator>) {
+            return detail::allocate_bytes(allocator_copy, size);
+        } else {
+            auto offset = allocator_offset(size);
+            auto allocated = detail::allocate_bytes(
+                allocator_copy, offset + sizeof(Allocator));
+            if (!allocated) {
+                return nullptr;
+            }
+
+            ::new (static_cast<void *>(allocated + offset))
+                Allocator(std::move(allocator_copy));
+            return allocated;
+        }
+    }
+
+    /**
+     * Deallocates a coroutine frame allocated by `allocate_frame`.
+     */
+    static void deallocate_frame(void * pointer, std::size_t size) noexcept
+    {
+        if constexpr (detail::is_stateless_allocator_v<Allocator>) {
+            Allocator allocator;
+            detail::deallocate_bytes(
+                allocator, static_cast<std::byte *>(pointer), size);
+        } else {
+            auto offset = allocator_offset(size);
+            auto & stored_allocator = *std::launder(reinterpret_cast<Allocator *>(
+                static_cast<std::byte *>(pointer) + offset));
+            auto allocator = std::move(stored_allocator);
+            stored_allocator.~Allocator();
+            detail::deallocate_bytes(allocator,
+                                     static_cast<std::byte *>(pointer),
+                                     offset + sizeof(Allocator));
+        }
+    }
+
+    /**
+     * The exit condition of the function.
+     */
+    exit_condition<Type, Allocator>
+        m_condition{};
+};
+
+#ifdef __cpp_lib_memory_resource
+namespace pmr
+{
+/**
+ * A throwing coroutine whose frame and exceptions are allocated from a
+ * `std::pmr::memory_resource`. The memory resource is passed using
+ * leading `std::allocator_arg_t, std::pmr::memory_resource *` parameters,
+ * otherwise the default memory resource is used.
+ * ```cpp
+ * zpp::pmr::throwing<int> foo(std::allocator_arg_t,
+ *                             std::pmr::memory_resource * resource);
+ * ```
+ */
+template <typename Type>
+using throwing =
+    zpp::throwing<Type, std::pmr::polymorphic_allocator<std::byte>>;
+} // namespace pmr
+#endif
+
+/**
+ * Declares the complete set of exceptions and error codes that a
+ * coroutine may throw, see `zpp::throwing<Type, zpp::throws<...>>`.
+ */
+template <typename... Exceptions>
+struct throws
+{
+};
+
+namespace detail
+{
+/**
+ * A union of the given types, whose active member is tracked by the
+ * owner.
+ */
+template <typename... Types>
+union variadic_union
+{
+};
+
+template <typename First, typename... Rest>
+union variadic_union<First, Rest...>
+{
+    constexpr variadic_union() noexcept : rest()
+    {
+    }
+
+    ~variadic_union()
+    {
+    }
+
+    template <std::size_t Index>
+    constexpr auto & get() noexcept
+    {
+        if constexpr (Index == 0) {
+            return first;
+        } else {
+            return rest.template get<Index - 1>();
+        }
+    }
+
+    First first;
+    variadic_union<Rest...> rest;
+};
+
+/**
+ * The index of `Type` within `Types`, or the number of `Types` if
+ * absent.
+ */
+template <typename Type, typename... Types>
+inline constexpr std::size_t type_index_v = [] {
+    std::size_t index = 0;
+    static_cast<void>(
+        (... || (std::is_same_v<Type, Types> || (++index, false))));
+    return index;
+}();
+
+template <typename... Path>
+auto last_type(type_list<Path...>) -> std::type_identity<
+    std::tuple_element_t<sizeof...(Path) - 1, std::tuple<Path...>>>;
+
+template <typename Ancestor, typename Paths>
+inline constexpr bool is_ancestor_path_v = false;
+
+template <typename Ancestor, typename... Paths>
+inline constexpr bool is_ancestor_path_v<Ancestor, type_list<Paths...>> =
+    (... ||
+     std::is_same_v<Ancestor,
+                    typename decltype(last_type(Paths{}))::type>);
+
+/**
+ * Returns true if a catch clause of `CatchType` catches `Exception`,
+ * known at compile time from the registered bases of `Exception`.
+ */
+template <typename Exception, typename CatchType>
+constexpr bool is_caught_as() noexcept
+{
+    if constexpr (std::is_void_v<CatchType> ||
+                  std::is_same_v<CatchType, Exception>) {
+        return true;
+    } else if constexpr (std::is_enum_v<Exception>) {
+        return std::is_same_v<CatchType, error>;
+    } else if constexpr (requires { define_exception<CatchType>(); }) {
+        return is_ancestor_path_v<
+            CatchType,
+            typename ancestor_paths<type_list<Exception>,
+                                    define_exception_t<Exception>>::type>;
+    } else {
+        return false;
+    }
+}
+
+/**
+ * The index of the first catch clause that catches `Exception`, or the
+ * number of clauses if none does.
+ */
+template <typename Exception, typename... Clauses>
+inline constexpr std::size_t catching_clause_v = [] {
+    std::size_t index = 0;
+    static_cast<void>(
+        (... ||
+         (is_caught_as<Exception, catch_value_type_t<Clauses>>() ||
+          (++index, false))));
+    return index;
+}();
+} // namespace detail
+
+/**
+ * A throwing coroutine whose exceptions are statically known to be one
+ * of `Exceptions`, each either an exception type or an error code
+ * enumeration:
+ * ```cpp
+ * zpp::throwing<int, zpp::throws<parse_error, std::errc>>
+ * parse(std::string_view text)
+ * {
+ *     if (text.empty()) {
+ *         co_yield std::errc::invalid_argument;
+ *     }
+ *     co_yield parse_error("Unexpected character.");
+ * }
+ * ```
+ * The thrown exception is stored within the result next to a one byte
+ * index of its type, without type erasure, allocation, or a dynamic
+ * cast to match catch clauses, whose choice for each of `Exceptions` is
+ * made at compile time. Such a coroutine may only throw `Exceptions`,
+ * and only await coroutines that throw a subset of them. When awaited
+ * from a `zpp::throwing<Type, Allocator>`, the exception is converted
+ * to the type erased form.
+ *
+ * Catch clauses must not throw, and every one of `Exceptions` must be
+ * caught. To rethrow, await the result from a type erased coroutine
+ * and catch it there.
+ */
+template <typename Type, typename... Exceptions>
+class ZPP_THROWING_CORO_AWAIT_ELIDABLE [[nodiscard]] throwing<
+    Type,
+    throws<Exceptions...>>
+{
+public:
+    template <typename, typename>
+    friend class throwing;
+
+    struct zpp_throwing_tag
+    {
+    };
+
+    static_assert(sizeof...(Exceptions) < 0xff,
+                  "Too many exceptions in the exception set.");
+    static_assert((... && std::is_same_v<Exceptions,
+                                         std::remove_cvref_t<Exceptions>>),
+                  "Exceptions must not be references or cv qualified.");
+    static_assert((... && (std::is_enum_v<Exceptions> || requires {
+                              define_exception<Exceptions>();
+                          })),
+                  "Exceptions must be exceptions or error codes.");
+
+private:
+    /**
+     * The index of an empty result.
+     */
+    static constexpr std::uint8_t empty = 0xff;
+
+    /**
+     * The type in which the value is stored.
+     */
+    using value_type = std::conditional_t<
+        std::is_void_v<Type>,
+        void_t,
+        std::conditional_t<std::is_reference_v<Type>,
+                           std::remove_reference_t<Type> *,
+                           Type>>;
+
+    /**
+     * True if `Exception` is one of the declared exceptions.
+     */
+    template <typename Exception>
+    static constexpr bool is_declared_v =
+        detail::type_index_v<Exception, Exceptions...> !=
+        sizeof...(Exceptions);
+
+public:
+    /**
+     * The promise type to be extended with return value / return void
+     * functionality.
+     */
+    class basic_promise_type
+    {
+    public:
+        template <typename, typename>
+        friend class throwing;
+
+        basic_promise_type() = default;
 
-        throwing * m_return_object{};
-    };
+        struct suspend_destroy
+        {
+            constexpr bool await_ready() noexcept { return false; }
+            void await_suspend(auto handle) noexcept { handle.destroy(); }
+            [[noreturn]] void await_resume() noexcept { while (true); }
+        };
 
-    template <typename Base>
-    struct throwing_allocator : public Base
-    {
-        void * operator new(std::size_t size)
+        auto get_return_object()
         {
-            Allocator allocator;
-            return std::allocator_traits<Allocator>::allocate(allocator,
-                                                              size);
+            return throwing{static_cast<promise_type &>(*this)};
         }
 
-        void operator delete(void * pointer, std::size_t size) noexcept
+        auto initial_suspend() noexcept
         {
-            Allocator allocator;
-            std::allocator_traits<Allocator>::deallocate(
-                allocator, static_cast<std::byte *>(pointer), size);
+            return suspend_never{};
         }
 
-    protected:
-        ~throwing_allocator() = default;
-    };
-
-    template <typename Base>
-    struct noexcept_allocator : public Base
-    {
-        void * operator new(std::size_t size) noexcept
+        auto final_suspend() noexcept
         {
-            Allocator allocator;
-            return std::allocator_traits<Allocator>::allocate(allocator,
-                                                              size);
+            return suspend_never{};
         }
 
-        void operator delete(void * pointer, std::size_t size) noexcept
+        void unhandled_exception()
         {
-            Allocator allocator;
-            std::allocator_traits<Allocator>::deallocate(
-                allocator, static_cast<std::byte *>(pointer), size);
+            std::terminate();
         }
 
-        static auto get_return_object_on_allocation_failure()
+        /**
+         * Throw one of the exceptions and destroy calling coroutine.
+         */
+        template <typename Value>
+        auto yield_value(Value && value) requires
+            is_declared_v<std::remove_cvref_t<Value>>
         {
-            return throwing(nullptr);
+            m_return_object->exit_with_exception(std::forward<Value>(value));
+            return suspend_destroy{};
         }
 
     protected:
-        ~noexcept_allocator() = default;
+        ~basic_promise_type() = default;
+
+        throwing * m_return_object{};
     };
 
     /**
      * Add the return void functionality to base.
      */
-    template <typename Base>
-    struct promise_type_void : public Base
+    struct promise_type_void : public basic_promise_type
     {
-        using Base::Base;
-
         void return_void()
         {
-            Base::m_return_object->m_condition.exit_with_value();
+            basic_promise_type::m_return_object->exit_with_value();
         }
     };
 
     /**
      * Add the return value functionality to base.
      */
-    template <typename Base>
-    struct promise_type_nonvoid : public Base
+    struct promise_type_nonvoid : public basic_promise_type
     {
-        using Base::Base;
-
         template <typename T>
         void return_value(T && value)
         {
-            if constexpr (requires {
-                              Base::throw_it(std::forward<T>(value));
-                          }) {
-                Base::throw_it(std::forward<T>(value));
+            if constexpr (is_declared_v<std::remove_cvref_t<T>>) {
+                basic_promise_type::m_return_object->exit_with_exception(
+                    std::forward<T>(value));
             } else {
-                Base::m_return_object->m_condition.exit_with_value(
+                basic_promise_type::m_return_object->exit_with_value(
                     std::forward<T>(value));
             }
         }
     };
 
-    static constexpr bool is_noexcept_allocator =
-        noexcept(std::declval<std::conditional_t<std::is_void_v<Allocator>,
-                                                 std::allocator<std::byte>,
-                                                 Allocator>>()
-                     .allocate(std::size_t{}));
-
-    /**
-     * The actual promise type, which adds the appropriate
-     * return strategy to the basic promise type.
-     */
-    using promise_type = std::conditional_t<
-        std::is_void_v<Type>,
-        std::conditional_t<
-            std::is_void_v<Allocator>,
-            promise_type_void<basic_promise_type>,
-            std::conditional_t<
-                is_noexcept_allocator,
-                promise_type_void<noexcept_allocator<basic_promise_type>>,
-                promise_type_void<
-                    throwing_allocator<basic_promise_type>>>>,
-        std::conditional_t<
-            std::is_void_v<Allocator>,
-            promise_type_nonvoid<basic_promise_type>,
-            std::conditional_t<is_noexcept_allocator,
-                               promise_type_nonvoid<
-                                   noexcept_allocator<basic_promise_type>>,
-                               promise_type_nonvoid<throwing_allocator<
-                                   basic_promise_type>>>>>;
-
     /**
-     * Constructor for out of memory scenario.
+     * The actual promise type.
      */
-    constexpr explicit throwing(std::nullptr_t) noexcept
-    {
-        m_condition.exit_with_error(std::errc::not_enough_memory);
-    }
+    using promise_type = std::conditional_t<std::is_void_v<Type>,
+                                            promise_type_void,
+                                            promise_type_nonvoid>;
 
     /**
      * Construct from the coroutine handle.
@@ -1100,42 +4964,57 @@ public:
      */
     constexpr throwing(auto && value) requires(
         std::is_convertible_v<decltype(value), Type> &&
-        !requires(promise_type & promise) {
-            promise.throw_it(std::forward<decltype(value)>(value));
-        }) ||
+        !is_declared_v<std::remove_cvref_t<decltype(value)>>) ||
         (std::is_void_v<Type> &&
-         std::is_same_v<
-             std::remove_cv_t<std::remove_reference_t<decltype(value)>>,
-             void_t>) :
-        m_condition(std::forward<decltype(value)>(value))
+         std::is_same_v<std::remove_cvref_t<decltype(value)>, void_t>)
     {
+        if constexpr (std::is_void_v<Type>) {
+            exit_with_value();
+        } else {
+            exit_with_value(std::forward<decltype(value)>(value));
+        }
     }
 
     /**
-     * Construct directly from an error/exception.
+     * Construct directly from one of the exceptions.
      */
-    constexpr throwing(auto && value) requires requires(promise_type & promise)
+    constexpr throwing(auto && value) requires
+        is_declared_v<std::remove_cvref_t<decltype(value)>>
     {
-        promise.throw_it(std::forward<decltype(value)>(value));
+        exit_with_exception(std::forward<decltype(value)>(value));
     }
+
+    /**
+     * Move construct from other.
+     */
+    constexpr throwing(throwing && other) noexcept(
+        (std::is_nothrow_move_constructible_v<value_type> && ... &&
+         std::is_nothrow_move_constructible_v<Exceptions>))
     {
-        if constexpr (requires {
-                          define_exception<std::remove_cv_t<
-                              std::remove_reference_t<decltype(value)>>>();
-                      }) {
-            m_condition.exit_with_exception(
-                std::forward<decltype(value)>(value));
-        } else {
-            m_condition.exit_with_error(
-                std::forward<decltype(value)>(value));
+        if (other.m_index == empty) {
+            return;
         }
+
+        other.visit([&](auto & stored, auto index) {
+            ::new (static_cast<void *>(
+                std::addressof(m_storage.template get<index>())))
+                std::remove_reference_t<decltype(stored)>(std::move(stored));
+        });
+        m_index = other.m_index;
     }
 
+    throwing & operator=(throwing &&) = delete;
+
     /**
-     * Rethrow an exception.
+     * Destroys the stored value or exception.
      */
-    constexpr throwing(rethrow_t) noexcept
+    constexpr ~throwing()
     {
+        if (m_index != empty) {
+            visit([](auto & stored, auto) {
+                std::destroy_at(std::addressof(stored));
+            });
+        }
     }
 
     /**
@@ -1143,17 +5022,41 @@ public:
      */
     constexpr bool await_ready() noexcept
     {
-        return m_condition.success();
+        return !m_index;
     }
 
     /**
-     * Suspend execution only if there is an exception to be thrown.
+     * Suspend execution only if there is an exception to be thrown,
+     * which is moved into the awaiting coroutine, converting it to the
+     * type erased form if the awaiting coroutine is not of a declared
+     * exception set.
      */
     template <typename PromiseType>
     void await_suspend(coroutine_handle<PromiseType> outer_handle) noexcept
     {
-        outer_handle.promise().m_return_object->m_condition.exit_propagate(
-            m_condition);
+        auto & promise = outer_handle.promise();
+        auto & outer = *promise.m_return_object;
+        visit([&](auto & stored, auto index) {
+            if constexpr (index != 0) {
+                using exception_type =
+                    std::remove_reference_t<decltype(stored)>;
+                if constexpr (requires { outer.m_condition; }) {
+                    if constexpr (std::is_enum_v<exception_type>) {
+                        outer.m_condition.exit_with_error(stored);
+                    } else {
+                        outer.m_condition.exit_with_exception(
+                            std::move(stored), promise.m_allocator);
+                    }
+                } else {
+                    static_assert(
+                        std::remove_reference_t<decltype(
+                            outer)>::template is_declared_v<exception_type>,
+                        "Awaited coroutine throws an exception that is "
+                        "not declared by the awaiting coroutine.");
+                    outer.exit_with_exception(std::move(stored));
+                }
+            }
+        });
         outer_handle.destroy();
     }
 
@@ -1162,11 +5065,7 @@ public:
      */
     decltype(auto) await_resume() noexcept
     {
-        if constexpr (std::is_void_v<Type>) {
-            return;
-        } else {
-            return std::move(m_condition).value();
-        }
+        return std::move(*this).value();
     }
 
     /**
@@ -1175,7 +5074,7 @@ public:
      */
     constexpr explicit operator bool() const noexcept
     {
-        return m_condition.success();
+        return !m_index;
     }
 
     /**
@@ -1184,7 +5083,7 @@ public:
      */
     constexpr bool success() const noexcept
     {
-        return m_condition.success();
+        return !m_index;
     }
 
     /**
@@ -1193,7 +5092,7 @@ public:
      */
     constexpr bool failure() const noexcept
     {
-        return m_condition.failure();
+        return m_index;
     }
 
     /**
@@ -1204,8 +5103,10 @@ public:
     {
         if constexpr (std::is_void_v<Type>) {
             return;
+        } else if constexpr (std::is_reference_v<Type>) {
+            return static_cast<Type>(*m_storage.template get<0>());
         } else {
-            return std::move(m_condition).value();
+            return std::move(m_storage.template get<0>());
         }
     }
 
@@ -1217,398 +5118,146 @@ public:
     {
         if constexpr (std::is_void_v<Type>) {
             return;
+        } else if constexpr (std::is_reference_v<Type>) {
+            return static_cast<Type>(*m_storage.template get<0>());
         } else {
-            return m_condition.value();
+            return (m_storage.template get<0>());
         }
     }
 
-private:
     /**
      * Allows to catch exceptions. Each parameter is a catch clause
-     * that receives one parameter of the exception to be caught. A
-     * catch clause may itself be throwing. The last catch clause may
-     * have no parameters and as such catches all exceptions. Must
+     * that receives one parameter of the exception to be caught, and
+     * the last catch clause may have no parameters and as such catches
+     * all exceptions. For each of the declared exceptions, the first
+     * clause that catches it is chosen at compile time, so that
+     * catching is a dispatch on the stored exception index. Must
      * return a value of the same type as the previously executed
-     * coroutine that is being checked for exceptions. This overload is
-     * for catch clauses that may themselves throw.
+     * coroutine that is being checked for exceptions.
      */
-    template <typename Clause,
-              typename... Clauses,
-              typename...,
-              typename CatchType = detail::catch_value_type_t<Clause>,
-              bool IsThrowing = requires
-    {
-        typename std::invoke_result_t<Clause>::zpp_throwing_tag;
-    }
-    || requires
+    template <typename... Clauses>
+    constexpr inline Type catches(Clauses &&... clauses)
     {
-        typename std::invoke_result_t<
-            Clause,
-            std::conditional_t<std::is_void_v<CatchType>,
-                               int,
-                               CatchType> &>::zpp_throwing_tag;
-    }
-    >
-    requires IsThrowing ||
-        (... ||
-         (
-             requires {
-                 typename std::invoke_result_t<Clauses>::zpp_throwing_tag;
-             } ||
-             requires {
-                 typename std::invoke_result_t<
-                     Clauses,
-                     std::conditional_t<
-                         std::is_void_v<
-                             detail::catch_value_type_t<Clauses>>,
-                         int,
-                         detail::catch_value_type_t<Clauses>> &>::
-                     zpp_throwing_tag;
-             })) ||
-        (!requires {
-            typename std::invoke_result_t<
-                decltype(std::get<sizeof...(Clauses)>(
-                    std::declval<std::tuple<Clause, Clauses...>>()))>;
-        }) constexpr throwing
-        catch_exception_object(const dynamic_object & exception,
-                               Clause && clause,
-                               Clauses &&... clauses)
-    {
-        if constexpr (std::is_void_v<CatchType>) {
-            static_assert(0 == sizeof...(Clauses),
-                          "Catch all clause must be the last one.");
-            if constexpr (IsThrowing) {
-                auto result = std::forward<Clause>(clause)();
-                if (!result.is_rethrow()) [[likely]] {
-                    if (exception.address) {
-                        exception_ptr<Allocator>(
-                            std::addressof(m_condition.exception()));
-                    }
-                    return result;
-                } else [[unlikely]] {
-                    return std::move(*this);
-                }
-            } else {
-                if (exception.address) {
-                    exception_ptr<Allocator>(
-                        std::addressof(m_condition.exception()));
-                }
-                if constexpr (std::is_void_v<decltype(std::forward<Clause>(
-                                  clause)())>) {
-                    std::forward<Clause>(clause)();
-                    return void_v;
-                } else {
-                    return std::forward<Clause>(clause)();
-                }
-            }
-        } else if constexpr (requires {
-                                 std::forward<Clause>(clause)(
-                                     m_condition.error());
-                             }) {
-            if (exception.address) {
-                if constexpr (0 != sizeof...(Clauses)) {
-                    return catch_exception_object(
-                        exception, std::forward<Clauses>(clauses)...);
-                } else {
-                    return std::move(*this);
-                }
-            }
-
-            if constexpr (IsThrowing) {
-                auto result =
-                    std::forward<Clause>(clause)(m_condition.error());
-                if (!result.is_rethrow()) [[likely]] {
-                    return result;
-                } else [[unlikely]] {
-                    return std::move(*this);
-                }
-            } else {
-                if constexpr (std::is_void_v<decltype(std::forward<Clause>(
-                                  clause)(m_condition.error())
-
-                                                          )>) {
-                    std::forward<Clause>(clause)(m_condition.error());
-                    return void_v;
-                } else {
-                    return std::forward<Clause>(clause)(
-                        m_condition.error());
-                }
-            }
-        } else if constexpr (requires { error{CatchType{}}; }) {
-            if (exception.address ||
-                std::addressof(m_condition.error().domain()) !=
-                    std::addressof(err_domain<CatchType>)) {
-                if constexpr (0 != sizeof...(Clauses)) {
-                    return catch_exception_object(
-                        exception, std::forward<Clauses>(clauses)...);
-                } else {
-                    return std::move(*this);
-                }
-            }
-
-            if constexpr (IsThrowing) {
-                auto result = std::forward<Clause>(clause)(
-                    CatchType{m_condition.error().code()});
-                if (!result.is_rethrow()) [[likely]] {
-                    return result;
-                } else [[unlikely]] {
-                    return std::move(*this);
-                }
-            } else {
-                if constexpr (std::is_void_v<decltype(std::forward<Clause>(
-                                  clause)(CatchType{
-                                  m_condition.error().code()}))>) {
-                    std::forward<Clause>(clause)(
-                        CatchType{m_condition.error().code()});
-                    return void_v;
-                } else {
-                    return std::forward<Clause>(clause)(
-                        CatchType{m_condition.error().code()});
-                }
-            }
-        } else if constexpr (requires { define_exception<CatchType>(); }) {
-            CatchType * catch_object = nullptr;
-            if (exception.address) {
-                catch_object = static_cast<CatchType *>(
-                    detail::dyn_cast(detail::type_id<CatchType>(),
-                                     exception.address,
-                                     exception.type_id));
-            }
-
-            if (!catch_object) {
-                if constexpr (0 != sizeof...(Clauses)) {
-                    return catch_exception_object(
-                        exception, std::forward<Clauses>(clauses)...);
-                } else {
-                    return std::move(*this);
-                }
-            }
-
-            if constexpr (IsThrowing) {
-                auto result = std::forward<Clause>(clause)(*catch_object);
-                if (!result.is_rethrow()) [[likely]] {
-                    exception_ptr<Allocator>(
-                        std::addressof(m_condition.exception()));
-                    return result;
-                } else [[unlikely]] {
-                    return std::move(*this);
-                }
-            } else {
-                exception_ptr<Allocator> exception_disposer(
-                    std::addressof(m_condition.exception()));
-                if constexpr (std::is_void_v<decltype(std::forward<Clause>(
-                                  clause)(*catch_object))>) {
-                    std::forward<Clause>(clause)(*catch_object);
-                    return void_v;
+        // If there is no exception, skip.
+        if (!m_index) [[likely]] {
+            return std::move(*this).value();
+        } else [[unlikely]] {
+            return visit([&](auto & stored, auto index) -> Type {
+                if constexpr (index == 0) {
+                    // Unreachable, a value is handled above.
+                    std::terminate();
                 } else {
-                    return std::forward<Clause>(clause)(*catch_object);
+                    using exception_type =
+                        std::remove_reference_t<decltype(stored)>;
+                    constexpr auto clause_index =
+                        detail::catching_clause_v<exception_type,
+                                                  Clauses...>;
+                    static_assert(clause_index != sizeof...(Clauses),
+                                  "Missing catch clause for a declared "
+                                  "exception.");
+                    return catch_exception<exception_type>(
+                        stored,
+                        std::get<clause_index>(
+                            std::forward_as_tuple(clauses...)));
                 }
-            }
-        } else {
-            static_assert(std::is_void_v<CatchType>,
-                          "Invalid catch clause.");
+            });
         }
     }
 
+private:
     /**
-     * Allows to catch exceptions. Each parameter is a catch clause
-     * that receives one parameter of the exception to be caught. A
-     * catch clause may itself be throwing. The last catch clause may
-     * have no parameters and as such catches all exceptions. Must
-     * return a value of the same type as the previously executed
-     * coroutine that is being checked for exceptions. This overload is
-     * for catch clauses that cannot throw.
+     * Calls the catch clause with the exception.
      */
-    template <typename Clause,
-              typename... Clauses,
-              typename...,
-              typename CatchType = detail::catch_value_type_t<Clause>,
-              bool IsThrowing = requires
-    {
-        typename std::invoke_result_t<Clause>::zpp_throwing_tag;
-    }
-    || requires
+    template <typename Exception, typename Clause>
+    static constexpr Type catch_exception(Exception & exception,
+                                          Clause & clause)
     {
-        typename std::invoke_result_t<
-            Clause,
-            std::conditional_t<std::is_void_v<CatchType>,
-                               int,
-                               CatchType> &>::zpp_throwing_tag;
-    }
-    >
-    requires (!(IsThrowing ||
-        (... ||
-         (
-             requires {
-                 typename std::invoke_result_t<Clauses>::zpp_throwing_tag;
-             } ||
-             requires {
-                 typename std::invoke_result_t<
-                     Clauses,
-                     std::conditional_t<
-                         std::is_void_v<
-                             detail::catch_value_type_t<Clauses>>,
-                         int,
-                         detail::catch_value_type_t<Clauses>> &>::
-                     zpp_throwing_tag;
-             })) ||
-        (!requires {
-            typename std::invoke_result_t<
-                decltype(std::get<sizeof...(Clauses)>(
-                    std::declval<std::tuple<Clause, Clauses...>>()))>;
-
-        })))
-    constexpr Type catch_exception_object(const dynamic_object & exception,
-                                          Clause && clause,
-                                          Clauses &&... clauses)
-    {
-        if constexpr (std::is_void_v<CatchType>) {
-            static_assert(!sizeof...(Clauses),
-                          "Catch all object with no parameters must "
-                          "be the last one.");
-            if (exception.address) {
-                exception_ptr<Allocator>(
-                    std::addressof(m_condition.exception()));
-            }
-            return std::forward<Clause>(clause)();
-        } else if constexpr (requires {
-                                 std::forward<Clause>(clause)(
-                                     m_condition.error());
-                             }) {
-            if (exception.address) {
-                static_assert(0 != sizeof...(Clauses),
-                              "Missing catch all block in non "
-                              "throwing catches.");
-                return catch_exception_object(
-                    exception, std::forward<Clauses>(clauses)...);
-            }
-
-            return std::forward<Clause>(clause)(m_condition.error());
-        } else if constexpr (requires { error{CatchType{}}; }) {
-            if (exception.address ||
-                std::addressof(m_condition.error().domain()) !=
-                    std::addressof(err_domain<CatchType>)) {
-                static_assert(0 != sizeof...(Clauses),
-                              "Missing catch all block in non "
-                              "throwing catches.");
-                return catch_exception_object(
-                    exception, std::forward<Clauses>(clauses)...);
-            }
-
-            return std::forward<Clause>(clause)(
-                CatchType{m_condition.error().code()});
-        } else if constexpr (requires { define_exception<CatchType>(); }) {
-            CatchType * catch_object = nullptr;
-            if (exception.address) {
-                catch_object = static_cast<CatchType *>(
-                    detail::dyn_cast(detail::type_id<CatchType>(),
-                                     exception.address,
-                                     exception.type_id));
-            }
-
-            if (!catch_object) {
-                static_assert(0 != sizeof...(Clauses),
-                              "Missing catch all block in non "
-                              "throwing catches.");
-                return catch_exception_object(
-                    exception, std::forward<Clauses>(clauses)...);
-            }
-
-            exception_ptr<Allocator> exception_disposer(
-                std::addressof(m_condition.exception()));
-            return std::forward<Clause>(clause)(*catch_object);
+        using catch_type = detail::catch_value_type_t<Clause>;
+        static_assert(
+            !requires {
+                typename std::invoke_result_t<
+                    Clause,
+                    std::conditional_t<std::is_void_v<catch_type>,
+                                       int,
+                                       catch_type &>>::zpp_throwing_tag;
+            } && !requires {
+                typename std::invoke_result_t<Clause>::zpp_throwing_tag;
+            },
+            "Catch clauses of declared exceptions must not throw.");
+
+        if constexpr (std::is_void_v<catch_type>) {
+            return clause();
+        } else if constexpr (std::is_same_v<catch_type, error>) {
+            return clause(error(exception));
         } else {
-            static_assert(std::is_void_v<CatchType>,
-                          "Invalid catch clause.");
+            return clause(static_cast<catch_type &>(exception));
         }
     }
 
-    /**
-     * Returns true if rethrowing, else false.
-     */
-    constexpr bool is_rethrow() const noexcept
-    {
-        return m_condition.is_rethrow();
-    }
-
-public:
-    /**
-     * Allows to catch exceptions. Each parameter is a catch clause
-     * that receives one parameter of the exception to be caught. A
-     * catch clause may itself be throwing. The last catch clause may
-     * have no parameters and as such catches all exceptions. Must
-     * return a value of the same type as the previously executed
-     * coroutine that is being checked for exceptions. This overload is
-     * for catch clauses that may themselves throw.
-     */
-    template <typename... Clauses>
-    constexpr inline throwing
-    catches(Clauses &&... clauses) requires requires
-    {
-        typename decltype(this->catch_exception_object(
-            exception_object::null_dynamic_object,
-            std::forward<Clauses>(clauses)...))::zpp_throwing_tag;
-    }
-    {
-        // If there is no exception, skip.
-        if (m_condition) [[likely]] {
-            return std::move(*this);
-        } else [[unlikely]] {
-            // Follow to catch the exception.
-            return catch_exception_object(
-                // Increase chance `catches` gets inlined.
-                [&] {
-                    return m_condition.is_exception()
-                               ? m_condition.exception().dynamic_object()
-                               : exception_object::null_dynamic_object;
-                }(),
-                std::forward<Clauses>(clauses)...);
+    /**
+     * Calls the function with the stored value or exception and its
+     * index as an `std::integral_constant`.
+     */
+    template <std::size_t Index = 0>
+    constexpr decltype(auto) visit(auto && function)
+    {
+        if constexpr (Index == sizeof...(Exceptions)) {
+            return function(
+                m_storage.template get<Index>(),
+                std::integral_constant<std::size_t, Index>{});
+        } else {
+            if (m_index == Index) {
+                return function(
+                    m_storage.template get<Index>(),
+                    std::integral_constant<std::size_t, Index>{});
+            }
+            return visit<Index + 1>(function);
         }
     }
 
     /**
-     * Allows to catch exceptions. Each parameter is a catch clause
-     * that receives one parameter of the exception to be caught. A
-     * catch clause may itself be throwing. The last catch clause may
-     * have no parameters and as such catches all exceptions. Must
-     * return a value of the same type as the previously executed
-     * coroutine that is being checked for exceptions. This overload is
-     * for catch clauses that do not throw.
+     * Stores the value.
      */
-    template <typename... Clauses>
-    constexpr inline Type
-    catches(Clauses &&... clauses) requires(!requires {
-        typename decltype(this->catch_exception_object(
-            exception_object::null_dynamic_object,
-            std::forward<Clauses>(clauses)...))::zpp_throwing_tag;
-    })
+    template <typename... Arguments>
+    constexpr void exit_with_value(Arguments &&... arguments)
     {
-        // If there is no exception, skip.
-        if (m_condition) [[likely]] {
-            if constexpr (std::is_void_v<Type>) {
-                return;
-            } else {
-                return std::move(*this).value();
-            }
-        } else [[unlikely]] {
-            // Follow to catch the exception.
-            return catch_exception_object(
-                // Increase chance `catches` gets inlined.
-                [&] {
-                    return m_condition.is_exception()
-                               ? m_condition.exception().dynamic_object()
-                               : exception_object::null_dynamic_object;
-                }(),
-                std::forward<Clauses>(clauses)...);
+        if constexpr (std::is_reference_v<Type>) {
+            ::new (static_cast<void *>(
+                std::addressof(m_storage.template get<0>())))
+                value_type(std::addressof(arguments)...);
+        } else {
+            ::new (static_cast<void *>(
+                std::addressof(m_storage.template get<0>())))
+                value_type(std::forward<Arguments>(arguments)...);
         }
+        m_index = 0;
     }
 
-private :
     /**
-     * The exit condition of the function.
+     * Stores one of the exceptions.
      */
-    exit_condition<Type, Allocator>
-        m_condition{};
+    template <typename Value>
+    constexpr void exit_with_exception(Value && value)
+    {
+        using exception_type = std::remove_cvref_t<Value>;
+        constexpr auto index =
+            detail::type_index_v<exception_type, Exceptions...> + 1;
+        ::new (static_cast<void *>(
+            std::addressof(m_storage.template get<index>())))
+            exception_type(std::forward<Value>(value));
+        m_index = index;
+    }
+
+    /**
+     * The index of the stored alternative, zero for a value, one past
+     * the index of the stored exception otherwise.
+     */
+    std::uint8_t m_index = empty;
+
+    /**
+     * The stored value or exception.
+     */
+    detail::variadic_union<value_type, Exceptions...> m_storage;
 };
 
 /**
@@ -1648,6 +5297,391 @@ constexpr decltype(auto) try_catch(
     }
 }
 
+/**
+ * Like `zpp::try_catch`, and installs a `zpp::scoped_arena` for the
+ * duration of the try and catch clauses. Frames and exceptions of
+ * coroutines using `zpp::scoped_arena_allocator` are allocated from the
+ * arena, which is reset in one shot when the outermost `arena_try_catch`
+ * completes. The catch clauses must catch all exceptions and may not
+ * throw, so that no exception escapes the arena, use `zpp::try_catch`
+ * within the scope otherwise.
+ */
+template <typename TryClause, typename... CatchClause>
+decltype(auto) arena_try_catch(TryClause && try_clause,
+                               CatchClause &&... catch_clause)
+{
+    static_assert(
+        !requires {
+            typename decltype(try_catch(
+                std::forward<TryClause>(try_clause),
+                std::forward<CatchClause>(
+                    catch_clause)...))::zpp_throwing_tag;
+        },
+        "arena_try_catch must catch all exceptions without throwing.");
+
+    scoped_arena arena;
+    return try_catch(std::forward<TryClause>(try_clause),
+                     std::forward<CatchClause>(catch_clause)...);
+}
+
+/**
+ * A message with static lifetime, which may only be created at compile
+ * time from a string literal or another constant character array.
+ */
+class static_message
+{
+public:
+    template <std::size_t Size>
+    consteval static_message(const char (&message)[Size]) noexcept :
+        m_message(message, std::char_traits<char>::length(message))
+    {
+    }
+
+    constexpr std::string_view view() const noexcept
+    {
+        return m_message;
+    }
+
+private:
+    std::string_view m_message;
+};
+
+/**
+ * The base of exceptions that hold a message with static lifetime,
+ * such as a string literal, instead of allocating a copy of it like
+ * `std::runtime_error` does:
+ * ```cpp
+ * co_yield zpp::static_out_of_range("Key not found.");
+ * ```
+ * The message is checked at compile time, so that buffers with
+ * automatic lifetime are rejected.
+ */
+class static_error : public std::exception
+{
+public:
+    static_error(static_message message) noexcept :
+        m_message(message.view())
+    {
+    }
+
+    const char * what() const noexcept override
+    {
+        return m_message.data();
+    }
+
+    constexpr std::string_view message() const noexcept
+    {
+        return m_message;
+    }
+
+private:
+    std::string_view m_message;
+};
+
+/**
+ * Like `std::runtime_error`, with a static message.
+ */
+class static_runtime_error : public static_error
+{
+public:
+    using static_error::static_error;
+};
+
+/**
+ * Like `std::overflow_error`, with a static message.
+ */
+class static_overflow_error : public static_runtime_error
+{
+public:
+    using static_runtime_error::static_runtime_error;
+};
+
+/**
+ * Like `std::logic_error`, with a static message.
+ */
+class static_logic_error : public static_error
+{
+public:
+    using static_error::static_error;
+};
+
+/**
+ * Like `std::invalid_argument`, with a static message.
+ */
+class static_invalid_argument : public static_logic_error
+{
+public:
+    using static_logic_error::static_logic_error;
+};
+
+/**
+ * Like `std::out_of_range`, with a static message.
+ */
+class static_out_of_range : public static_logic_error
+{
+public:
+    using static_logic_error::static_logic_error;
+};
+
+namespace detail
+{
+/**
+ * Whether `format_writer` can format an argument of the given type,
+ * these are `bool`, `char`, character strings, integers and floating
+ * point numbers. Wide and unicode characters are not supported.
+ */
+template <typename Argument>
+inline constexpr bool is_format_argument_v =
+    std::is_same_v<Argument, bool> || std::is_same_v<Argument, char> ||
+    std::is_same_v<Argument, const char *> ||
+    std::is_same_v<Argument, char *> ||
+    std::is_convertible_v<const Argument &, std::string_view> ||
+    std::is_floating_point_v<Argument> ||
+    (std::is_integral_v<Argument> && !std::is_same_v<Argument, wchar_t> &&
+     !std::is_same_v<Argument, char8_t> &&
+     !std::is_same_v<Argument, char16_t> &&
+     !std::is_same_v<Argument, char32_t>);
+
+/**
+ * Writes formatted text into a buffer of the given size, truncating
+ * it, while counting the size of the whole text.
+ */
+struct format_writer
+{
+    void write(std::string_view text) noexcept
+    {
+        if (position < size) {
+            auto count = size - position < text.size() ? size - position
+                                                       : text.size();
+            std::memcpy(buffer + position, text.data(), count);
+        }
+        position += text.size();
+    }
+
+    /**
+     * Writes the format text up to and including the next `{}`
+     * placeholder, returns true if a placeholder was found. Use `{{` and
+     * `}}` for literal braces.
+     */
+    bool write_until_placeholder(std::string_view & format) noexcept
+    {
+        while (!format.empty()) {
+            auto index = format.find_first_of("{}");
+            if (index == std::string_view::npos) {
+                write(format);
+                format = {};
+                return false;
+            }
+
+            write(format.substr(0, index));
+            format.remove_prefix(index);
+            if (format.starts_with("{}")) {
+                format.remove_prefix(2);
+                return true;
+            } else if (format.starts_with("{{") ||
+                       format.starts_with("}}")) {
+                write(format.substr(0, 1));
+                format.remove_prefix(2);
+            } else {
+                write(format.substr(0, 1));
+                format.remove_prefix(1);
+            }
+        }
+        return false;
+    }
+
+    template <typename Argument>
+    void write_argument(const Argument & argument) noexcept
+    {
+        if constexpr (std::is_same_v<Argument, bool>) {
+            write(argument ? "true" : "false");
+        } else if constexpr (std::is_same_v<Argument, char>) {
+            write(std::string_view(&argument, 1));
+        } else if constexpr (std::is_same_v<Argument, const char *> ||
+                             std::is_same_v<Argument, char *>) {
+            write(argument ? std::string_view(argument) : "(null)");
+        } else if constexpr (std::is_convertible_v<const Argument &,
+                                                   std::string_view>) {
+            write(std::string_view(argument));
+        } else if constexpr (std::is_floating_point_v<Argument>) {
+#ifdef __cpp_lib_to_chars
+            char text[64];
+            auto [end, error] =
+                std::to_chars(std::begin(text), std::end(text), argument);
+            write(std::string_view(text, std::size_t(end - text)));
+#else
+            static_assert(!std::is_floating_point_v<Argument>,
+                          "Floating point format arguments require "
+                          "std::to_chars floating point support.");
+#endif
+        } else if constexpr (is_format_argument_v<Argument>) {
+            char text[64];
+            auto [end, error] =
+                std::to_chars(std::begin(text), std::end(text), argument);
+            write(std::string_view(text, std::size_t(end - text)));
+        } else {
+            static_assert(std::is_void_v<Argument>,
+                          "Unsupported format argument type.");
+        }
+    }
+
+    template <typename... Arguments>
+    void format(std::string_view format,
+                const Arguments &... arguments) noexcept
+    {
+        (..., (write_until_placeholder(format)
+                   ? write_argument(arguments)
+                   : void()));
+
+        // Keep placeholders without arguments as is.
+        while (write_until_placeholder(format)) {
+            write("{}");
+        }
+    }
+
+    char * buffer{};
+    std::size_t size{};
+    std::size_t position{};
+};
+} // namespace detail
+
+/**
+ * The base of exceptions whose message is formatted from a format string
+ * and arguments only when it is first accessed, see
+ * `zpp::lazy_formatted_error`.
+ */
+class formatted_error : public std::exception
+{
+public:
+    formatted_error(formatted_error && other) noexcept :
+        std::exception(other),
+        m_format(other.m_format),
+        m_message(other.m_message.exchange(nullptr,
+                                           std::memory_order_relaxed))
+    {
+    }
+
+    formatted_error & operator=(formatted_error &&) = delete;
+
+    ~formatted_error() override
+    {
+        delete[] m_message.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Formats the message on first access. Thread safe, such that an
+     * exception shared between threads may be formatted by any of them,
+     * and the first formatted message is kept.
+     */
+    const char * what() const noexcept override
+    {
+        if (auto message = m_message.load(std::memory_order_acquire))
+            [[likely]] {
+            return message;
+        }
+
+        auto size = format(nullptr, 0);
+        auto message = new (std::nothrow) char[size + 1];
+        if (!message) [[unlikely]] {
+            return m_format.data();
+        }
+        format(message, size);
+        message[size] = '\0';
+
+        char * formatted = nullptr;
+        if (!m_message.compare_exchange_strong(formatted,
+                                               message,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+            // Another thread formatted the message first.
+            delete[] message;
+            return formatted;
+        }
+        return message;
+    }
+
+    constexpr std::string_view format_string() const noexcept
+    {
+        return m_format;
+    }
+
+    /**
+     * Returns true if the message was already formatted.
+     */
+    bool is_formatted() const noexcept
+    {
+        return m_message.load(std::memory_order_acquire);
+    }
+
+protected:
+    formatted_error(std::string_view format) noexcept :
+        m_format(format)
+    {
+    }
+
+    /**
+     * Formats up to `size` characters of the message into `buffer`,
+     * returns the size of the whole message.
+     */
+    virtual std::size_t format(char * buffer,
+                               std::size_t size) const noexcept = 0;
+
+private:
+    std::string_view m_format;
+    mutable std::atomic<char *> m_message{};
+};
+
+/**
+ * An exception that captures the arguments of its message by value, and
+ * formats them into the `{}` placeholders of the format string only when
+ * `what()` is first called, so that exceptions that are caught without
+ * reading the message do not pay for formatting it:
+ * ```cpp
+ * co_yield zpp::lazy_formatted_error("Key {} not found.", key);
+ * ```
+ * Supported arguments are `bool`, `char`, integers, floating point
+ * numbers and character strings, other types fail to compile. The
+ * format string, and string arguments that are not owned, such as
+ * `const char *`, must outlive the exception.
+ */
+template <typename... Arguments>
+class lazy_formatted_error : public formatted_error
+{
+    static_assert((... && detail::is_format_argument_v<Arguments>),
+                  "lazy_formatted_error arguments must be bool, char, "
+                  "integers, floating point numbers, const char *, "
+                  "std::string_view or std::string.");
+
+public:
+    template <std::size_t Size>
+    lazy_formatted_error(const char (&format)[Size],
+                         Arguments... arguments) :
+        formatted_error(std::string_view(format, Size - 1)),
+        m_arguments(std::move(arguments)...)
+    {
+    }
+
+protected:
+    std::size_t format(char * buffer,
+                       std::size_t size) const noexcept override
+    {
+        detail::format_writer writer{buffer, size};
+        std::apply(
+            [&](const auto &... arguments) {
+                writer.format(format_string(), arguments...);
+            },
+            m_arguments);
+        return writer.position;
+    }
+
+private:
+    std::tuple<Arguments...> m_arguments;
+};
+
+template <std::size_t Size, typename... Arguments>
+lazy_formatted_error(const char (&)[Size], Arguments...)
+    -> lazy_formatted_error<Arguments...>;
+
 template <>
 struct define_exception<std::exception>
 {
@@ -1732,6 +5766,79 @@ struct define_exception<std::bad_cast>
     using type = define_exception_bases<std::exception>;
 };
 
+template <>
+struct define_exception<static_error>
+{
+    using type = define_exception_bases<std::exception>;
+};
+
+template <>
+struct define_exception<static_runtime_error>
+{
+    using type = define_exception_bases<static_error>;
+};
+
+template <>
+struct define_exception<static_overflow_error>
+{
+    using type = define_exception_bases<static_runtime_error>;
+};
+
+template <>
+struct define_exception<static_logic_error>
+{
+    using type = define_exception_bases<static_error>;
+};
+
+template <>
+struct define_exception<static_invalid_argument>
+{
+    using type = define_exception_bases<static_logic_error>;
+};
+
+template <>
+struct define_exception<static_out_of_range>
+{
+    using type = define_exception_bases<static_logic_error>;
+};
+
+template <>
+struct define_exception<formatted_error>
+{
+    using type = define_exception_bases<std::exception>;
+};
+
+template <typename... Arguments>
+struct define_exception<lazy_formatted_error<Arguments...>>
+{
+    using type = define_exception_bases<formatted_error>;
+};
+
+// Static errors are meant to be thrown often, hence keep a few of them
+// for reuse so that throwing them does not allocate.
+template <>
+inline constexpr std::size_t exception_cache_capacity<static_error> = 4;
+
+template <>
+inline constexpr std::size_t
+    exception_cache_capacity<static_runtime_error> = 4;
+
+template <>
+inline constexpr std::size_t
+    exception_cache_capacity<static_overflow_error> = 4;
+
+template <>
+inline constexpr std::size_t
+    exception_cache_capacity<static_logic_error> = 4;
+
+template <>
+inline constexpr std::size_t
+    exception_cache_capacity<static_invalid_argument> = 4;
+
+template <>
+inline constexpr std::size_t
+    exception_cache_capacity<static_out_of_range> = 4;
+
 template <>
 inline constexpr auto err_domain<std::errc> = zpp::make_error_domain(
     "std::errc", std::errc{0}, [](auto code) constexpr->std::string_view {
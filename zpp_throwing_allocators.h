@@ -0,0 +1,568 @@
+#ifndef ZPP_THROWING_ALLOCATORS_H
+#define ZPP_THROWING_ALLOCATORS_H
+
+#include "zpp_throwing.h"
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace zpp
+{
+/**
+ * A pool allocator with separate slabs per NUMA node. Allocations are
+ * served from the slabs of the node of the CPU that the current thread
+ * runs on, and freed blocks return to the slabs of the node they were
+ * allocated from, wherever they are freed. Frees of blocks from another
+ * node are counted per node, see `statistics()`.
+ * ```cpp
+ * zpp::throwing<int, zpp::numa_pool_allocator> foo();
+ * ```
+ * Each thread caches blocks of its current node, and exchanges them
+ * with the shared free lists of the node in batches.
+ * Slabs are requested to be placed on their node with `mbind` on Linux,
+ * and are kept for the lifetime of the program. Allocations larger than
+ * `max_block_size` use the global operator new.
+ */
+class numa_pool_allocator
+{
+public:
+    using value_type = std::byte;
+
+    /**
+     * The size class granularity, block sizes are rounded up to it.
+     */
+    static constexpr std::size_t size_class_granularity = 64;
+
+    /**
+     * The number of size classes.
+     */
+    static constexpr std::size_t size_classes = 16;
+
+    /**
+     * The largest block size allocated from the pool.
+     */
+    static constexpr std::size_t max_block_size =
+        size_class_granularity * size_classes;
+
+    /**
+     * The number of nodes with distinct slabs, higher nodes share them.
+     */
+    static constexpr std::size_t max_nodes = 8;
+
+    /**
+     * The size and alignment of slabs.
+     */
+    static constexpr std::size_t slab_size = 256 * 1024;
+
+    /**
+     * The number of blocks exchanged between a thread cache and the
+     * free lists of a node at once.
+     */
+    static constexpr std::size_t batch_size = 32;
+
+    /**
+     * The number of allocations after which the node of the current
+     * thread is queried again, in case the thread migrated.
+     */
+    static constexpr std::size_t node_refresh_interval = 1024;
+
+    /**
+     * Statistics of a node.
+     */
+    struct statistics
+    {
+        std::size_t slabs{};
+        std::size_t cross_node_frees{};
+    };
+
+    std::byte * allocate(std::size_t size)
+    {
+        auto index = size_class(size);
+        if (index >= size_classes) [[unlikely]] {
+            return static_cast<std::byte *>(::operator new(size));
+        }
+
+        auto & thread = local_thread();
+        auto & list = thread.lists[thread.current_node()][index];
+        if (!list.head) [[unlikely]] {
+            s_nodes[thread.node].take(thread.node, index, list);
+        }
+
+        auto block = list.head;
+        list.head = block->next;
+        --list.count;
+        return reinterpret_cast<std::byte *>(block);
+    }
+
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        auto index = size_class(size);
+        if (index >= size_classes) [[unlikely]] {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto & thread = local_thread();
+        auto node = node_of(pointer);
+        if (node != thread.current_node()) [[unlikely]] {
+            s_nodes[node].cross_node_frees.fetch_add(
+                1, std::memory_order_relaxed);
+        }
+
+        auto & list = thread.lists[node][index];
+        list.head = ::new (pointer) free_block{list.head};
+        if (++list.count == 2 * batch_size) [[unlikely]] {
+            s_nodes[node].give(index, list, batch_size);
+        }
+    }
+
+    /**
+     * Returns the node of the CPU that the current thread runs on, or
+     * the simulated node of the thread if set.
+     */
+    static std::size_t current_node() noexcept
+    {
+        return local_thread().current_node();
+    }
+
+    /**
+     * Returns the node of a block allocated from the pool.
+     */
+    static std::size_t node_of(const void * pointer) noexcept
+    {
+        return reinterpret_cast<const slab *>(
+                   reinterpret_cast<std::uintptr_t>(pointer) &
+                   ~(slab_size - 1))
+            ->node;
+    }
+
+    /**
+     * Makes the current thread use the slabs of the given node regardless
+     * of the CPU it runs on, to simulate a topology.
+     */
+    static void simulate_node(std::size_t node) noexcept
+    {
+        local_thread().simulated_node = node % max_nodes;
+    }
+
+    /**
+     * Stops simulating the node of the current thread.
+     */
+    static void clear_simulated_node() noexcept
+    {
+        local_thread().simulated_node = no_node;
+        local_thread().refresh = 0;
+    }
+
+    /**
+     * Returns the statistics of the given node.
+     */
+    static struct statistics statistics(std::size_t node) noexcept
+    {
+        auto & pool = s_nodes[node % max_nodes];
+        return {pool.slabs.load(std::memory_order_relaxed),
+                pool.cross_node_frees.load(std::memory_order_relaxed)};
+    }
+
+    friend bool operator==(const numa_pool_allocator &,
+                           const numa_pool_allocator &) = default;
+
+private:
+    static constexpr std::size_t no_node = std::size_t(-1);
+
+    struct free_block
+    {
+        free_block * next;
+    };
+
+    struct free_list
+    {
+        free_block * head;
+        std::size_t count;
+    };
+
+    /**
+     * The header of a slab, blocks find it by alignment.
+     */
+    struct slab
+    {
+        static constexpr std::size_t header_size = size_class_granularity;
+
+        std::size_t node;
+    };
+
+    struct alignas(64) node
+    {
+        /**
+         * Moves a batch of free blocks, carving new blocks if needed,
+         * into the given empty list.
+         */
+        void take(std::size_t node_index,
+                  std::size_t index,
+                  free_list & list)
+        {
+            lock();
+            auto & shared = free_lists[index];
+            while (shared.head && list.count != batch_size) {
+                auto block = shared.head;
+                shared.head = block->next;
+                --shared.count;
+                block->next = list.head;
+                list.head = block;
+                ++list.count;
+            }
+
+            auto block_size = (index + 1) * size_class_granularity;
+            while (list.count != batch_size) {
+                if (std::size_t(ends[index] - untouched[index]) <
+                    block_size) {
+                    if (list.count) {
+                        break;
+                    }
+                    untouched[index] =
+                        create_slab(node_index) + slab::header_size;
+                    ends[index] =
+                        untouched[index] - slab::header_size + slab_size;
+                }
+                list.head = ::new (untouched[index])
+                    free_block{list.head};
+                untouched[index] += block_size;
+                ++list.count;
+            }
+            unlock();
+        }
+
+        /**
+         * Moves the given number of blocks from the list to the shared
+         * free list.
+         */
+        void give(std::size_t index,
+                  free_list & list,
+                  std::size_t count) noexcept
+        {
+            auto first = list.head;
+            auto last = first;
+            for (std::size_t i = 1; i < count; ++i) {
+                last = last->next;
+            }
+            list.head = last->next;
+            list.count -= count;
+
+            lock();
+            auto & shared = free_lists[index];
+            last->next = shared.head;
+            shared.head = first;
+            shared.count += count;
+            unlock();
+        }
+
+        void lock() noexcept
+        {
+            while (locked.exchange(true, std::memory_order_acquire)) {
+                while (locked.load(std::memory_order_relaxed)) {
+                }
+            }
+        }
+
+        void unlock() noexcept
+        {
+            locked.store(false, std::memory_order_release);
+        }
+
+        std::byte * create_slab(std::size_t node_index)
+        {
+            slabs.fetch_add(1, std::memory_order_relaxed);
+            return numa_pool_allocator::create_slab(node_index);
+        }
+
+        std::atomic<bool> locked;
+        free_list free_lists[size_classes];
+        std::byte * untouched[size_classes];
+        std::byte * ends[size_classes];
+        std::atomic<std::size_t> slabs;
+        std::atomic<std::size_t> cross_node_frees;
+    };
+
+    /**
+     * The state of a thread, including its cache of free blocks per
+     * node, which is returned to the nodes when the thread exits.
+     */
+    struct thread_state
+    {
+        ~thread_state()
+        {
+            for (std::size_t node = 0; node < max_nodes; ++node) {
+                for (std::size_t index = 0; index < size_classes;
+                     ++index) {
+                    auto & list = lists[node][index];
+                    if (list.count) {
+                        s_nodes[node].give(index, list, list.count);
+                    }
+                }
+            }
+        }
+
+        std::size_t current_node() noexcept
+        {
+            if (simulated_node != no_node) {
+                return node = simulated_node;
+            }
+            if (!refresh--) [[unlikely]] {
+                refresh = node_refresh_interval;
+                node = query_node();
+            }
+            return node;
+        }
+
+        std::size_t node{};
+        std::size_t refresh{};
+        std::size_t simulated_node{no_node};
+        free_list lists[max_nodes][size_classes]{};
+    };
+
+    /**
+     * Allocates a slab aligned to its size, requested to be placed on
+     * the given node if the system supports it.
+     */
+    static std::byte * create_slab(std::size_t node_index)
+    {
+        auto created = static_cast<std::byte *>(
+            ::operator new(slab_size, std::align_val_t{slab_size}));
+
+#if defined(__linux__) && defined(SYS_mbind)
+        // Prefer the node, failures such as for simulated nodes are
+        // ignored.
+        constexpr long mpol_preferred = 1;
+        unsigned long node_mask = 1ul << node_index;
+        ::syscall(SYS_mbind,
+                  created,
+                  slab_size,
+                  mpol_preferred,
+                  &node_mask,
+                  sizeof(node_mask) * 8,
+                  0);
+#endif
+
+        ::new (created) slab{node_index};
+        return created;
+    }
+
+    static std::size_t query_node() noexcept
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu{};
+        unsigned node{};
+        if (!::syscall(SYS_getcpu, &cpu, &node, nullptr)) {
+            return node % max_nodes;
+        }
+#endif
+        return 0;
+    }
+
+    static thread_state & local_thread() noexcept
+    {
+        static thread_local thread_state state;
+        return state;
+    }
+
+    static constexpr std::size_t size_class(std::size_t size) noexcept
+    {
+        return (size + size_class_granularity - 1) /
+                   size_class_granularity -
+               1;
+    }
+
+    static inline node s_nodes[max_nodes]{};
+};
+
+#if __has_include(<sys/mman.h>)
+/**
+ * An arena that reserves address space with `mmap`, requests that it is
+ * backed by huge pages where supported, and carves allocations from it
+ * contiguously, so that deep chains of coroutine frames touch few pages.
+ * Freeing the most recent allocation returns its memory to the arena
+ * immediately, and the arena is rewound when all allocations are freed.
+ * Allocation returns null when the arena is exhausted.
+ */
+class huge_page_arena
+{
+public:
+    /**
+     * The size of a huge page, the arena is aligned to it.
+     */
+    static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    /**
+     * The default capacity of an arena.
+     */
+    static constexpr std::size_t default_capacity = 32 * huge_page_size;
+
+    /**
+     * Reserves an arena of the given capacity, rounded up to huge pages.
+     * Memory is committed by the system as it is touched.
+     */
+    explicit huge_page_arena(std::size_t capacity = default_capacity)
+    {
+        capacity = (capacity + huge_page_size - 1) & ~(huge_page_size - 1);
+        auto reserved = ::mmap(nullptr,
+                               capacity + huge_page_size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                               -1,
+                               0);
+        if (reserved == MAP_FAILED) {
+            return;
+        }
+
+        // Trim the reservation to a huge page aligned range.
+        auto begin = reinterpret_cast<std::uintptr_t>(reserved);
+        auto aligned =
+            (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+        if (aligned != begin) {
+            ::munmap(reserved, aligned - begin);
+        }
+        if (auto tail = huge_page_size - (aligned - begin)) {
+            ::munmap(reinterpret_cast<void *>(aligned + capacity), tail);
+        }
+
+        m_begin = reinterpret_cast<std::byte *>(aligned);
+        m_end = m_begin + capacity;
+        m_top = m_begin;
+#ifdef MADV_HUGEPAGE
+        m_huge_pages = !::madvise(m_begin, capacity, MADV_HUGEPAGE);
+#endif
+    }
+
+    huge_page_arena(const huge_page_arena &) = delete;
+    huge_page_arena & operator=(const huge_page_arena &) = delete;
+
+    ~huge_page_arena()
+    {
+        if (m_begin) {
+            ::munmap(m_begin, std::size_t(m_end - m_begin));
+        }
+    }
+
+    /**
+     * Allocates from the arena, returns null if exhausted.
+     */
+    std::byte * allocate(std::size_t size) noexcept
+    {
+        size = round_size(size);
+        if (std::size_t(m_end - m_top) < size) [[unlikely]] {
+            return nullptr;
+        }
+
+        auto allocated = m_top;
+        m_top += size;
+        ++m_live;
+        return allocated;
+    }
+
+    /**
+     * Frees an allocation made by the arena.
+     */
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        if (!--m_live) {
+            m_top = m_begin;
+        } else if (pointer + round_size(size) == m_top) {
+            m_top = pointer;
+        }
+    }
+
+    /**
+     * Returns true if the pointer was allocated from the arena.
+     */
+    bool contains(const std::byte * pointer) const noexcept
+    {
+        return reinterpret_cast<std::uintptr_t>(pointer) -
+                   reinterpret_cast<std::uintptr_t>(m_begin) <
+               std::size_t(m_end - m_begin);
+    }
+
+    /**
+     * Returns true if huge pages were requested successfully.
+     */
+    bool huge_pages() const noexcept
+    {
+        return m_huge_pages;
+    }
+
+    /**
+     * Returns the number of bytes between the beginning of the arena
+     * and the most recent allocation that is still alive.
+     */
+    std::size_t used() const noexcept
+    {
+        return std::size_t(m_top - m_begin);
+    }
+
+private:
+    static constexpr std::size_t round_size(std::size_t size) noexcept
+    {
+        return (size + alignof(std::max_align_t) - 1) &
+               ~(alignof(std::max_align_t) - 1);
+    }
+
+    std::byte * m_begin{};
+    std::byte * m_end{};
+    std::byte * m_top{};
+    std::size_t m_live{};
+    bool m_huge_pages{};
+};
+
+/**
+ * Allocates coroutine frames and exceptions from a huge page arena of the
+ * current thread, which is reserved on first use. Allocations fall back
+ * to the global operator new when the arena is exhausted.
+ * ```cpp
+ * zpp::throwing<int, zpp::huge_page_allocator> foo();
+ * ```
+ * Objects must be freed on the thread that allocated them.
+ */
+struct huge_page_allocator
+{
+    using value_type = std::byte;
+
+    std::byte * allocate(std::size_t size)
+    {
+        if (auto allocated = arena().allocate(size)) [[likely]] {
+            return allocated;
+        }
+        return static_cast<std::byte *>(::operator new(size));
+    }
+
+    void deallocate(std::byte * pointer, std::size_t size) noexcept
+    {
+        auto & arena = huge_page_allocator::arena();
+        if (arena.contains(pointer)) [[likely]] {
+            arena.deallocate(pointer, size);
+            return;
+        }
+        ::operator delete(pointer);
+    }
+
+    /**
+     * Returns the arena of the current thread.
+     */
+    static huge_page_arena & arena() noexcept
+    {
+        static thread_local huge_page_arena arena;
+        return arena;
+    }
+
+    friend bool operator==(const huge_page_allocator &,
+                           const huge_page_allocator &) = default;
+};
+#endif
+
+} // namespace zpp
+
+#endif // ZPP_THROWING_ALLOCATORS_H